@@ -89,46 +89,70 @@ public:
 	}
 };
 
+v8::Handle<v8::Value> writer_class(v8::Isolate* isolate)
+{
+	// the class is bound once per isolate, each module instance
+	// only gets the constructor function
+	bool const bound = v8pp::class_<file_writer>::is_bound(isolate);
+	v8pp::class_<file_writer> file_writer_class(isolate);
+	if (!bound)
+	{
+		// .ctor<> template arguments declares types of file_writer constructor
+		// file_writer inherits from file_base_class
+		file_writer_class
+			.ctor<v8::FunctionCallbackInfo<v8::Value> const&>()
+			.inherit<file_base>()
+			.set("open", &file_writer::open)
+			.set("print", &file_writer::print)
+			.set("println", &file_writer::println)
+			;
+		file_writer_class.class_function_template()->SetClassName(v8pp::to_v8(isolate, "writer"));
+	}
+	return file_writer_class.js_function_template()->GetFunction();
+}
+
+v8::Handle<v8::Value> reader_class(v8::Isolate* isolate)
+{
+	bool const bound = v8pp::class_<file_reader>::is_bound(isolate);
+	v8pp::class_<file_reader> file_reader_class(isolate);
+	if (!bound)
+	{
+		// .ctor<> template arguments declares types of file_reader constructor.
+		// file_base inherits from file_base_class
+		file_reader_class
+			.ctor<char const*>()
+			.inherit<file_base>()
+			.set("open", &file_reader::open)
+			.set("getln", &file_reader::getline)
+			;
+		file_reader_class.class_function_template()->SetClassName(v8pp::to_v8(isolate, "reader"));
+	}
+	return file_reader_class.js_function_template()->GetFunction();
+}
+
 v8::Handle<v8::Value> init(v8::Isolate* isolate)
 {
 	v8::EscapableHandleScope scope(isolate);
 
 	// file_base binding, no .ctor() specified, object creation disallowed in JavaScript
-	v8pp::class_<file_base> file_base_class(isolate);
-	file_base_class
-		.set("close", &file_base::close)
-		.set("good", &file_base::good)
-		.set("is_open", &file_base::is_open)
-		.set("eof", &file_base::eof)
-		;
-
-	// .ctor<> template arguments declares types of file_writer constructor
-	// file_writer inherits from file_base_class
-	v8pp::class_<file_writer> file_writer_class(isolate);
-	file_writer_class
-		.ctor<v8::FunctionCallbackInfo<v8::Value> const&>()
-		.inherit<file_base>()
-		.set("open", &file_writer::open)
-		.set("print", &file_writer::print)
-		.set("println", &file_writer::println)
-		;
-
-	// .ctor<> template arguments declares types of file_reader constructor.
-	// file_base inherits from file_base_class
-	v8pp::class_<file_reader> file_reader_class(isolate);
-	file_reader_class
-		.ctor<char const*>()
-		.inherit<file_base>()
-		.set("open", &file_reader::open)
-		.set("getln", &file_reader::getline)
-		;
+	if (!v8pp::class_<file_base>::is_bound(isolate))
+	{
+		v8pp::class_<file_base> file_base_class(isolate);
+		file_base_class
+			.set("close", &file_base::close)
+			.set("good", &file_base::good)
+			.set("is_open", &file_base::is_open)
+			.set("eof", &file_base::eof)
+			;
+	}
 
 	// Create a module to add classes and functions to and return a
-	// new instance of the module to be embedded into the v8 context
+	// new instance of the module to be embedded into the v8 context.
+	// Derived classes are bound on first access from JavaScript.
 	v8pp::module m(isolate);
 	m.set("rename", &rename)
-	 .set("writer", file_writer_class)
-	 .set("reader", file_reader_class)
+	 .set_lazy("writer", &writer_class)
+	 .set_lazy("reader", &reader_class)
 		;
 
 	return scope.Escape(m.new_instance());
@@ -22,6 +22,22 @@ void run_tests()
 	void test_class();
 	void test_property();
 	void test_object();
+	void test_option_path();
+	void test_context_pool();
+	void test_isolate_pool();
+	void test_heap_stats();
+	void test_pooled_allocator();
+	void test_serialization();
+	void test_shared_ring();
+	void test_struct_options();
+	void test_handle_table();
+	void test_weak_cache();
+	void test_cached();
+	void test_bytes();
+	void test_ndarray();
+	void test_columns();
+	void test_json();
+	void test_value();
 
 	std::pair<char const*, void(*)()> tests[] =
 	{
@@ -37,6 +53,22 @@ void run_tests()
 		{ "test_class", test_class },
 		{ "test_property", test_property },
 		{ "test_object", test_object },
+		{ "test_option_path", test_option_path },
+		{ "test_context_pool", test_context_pool },
+		{ "test_isolate_pool", test_isolate_pool },
+		{ "test_heap_stats", test_heap_stats },
+		{ "test_pooled_allocator", test_pooled_allocator },
+		{ "test_serialization", test_serialization },
+		{ "test_shared_ring", test_shared_ring },
+		{ "test_struct_options", test_struct_options },
+		{ "test_handle_table", test_handle_table },
+		{ "test_weak_cache", test_weak_cache },
+		{ "test_cached", test_cached },
+		{ "test_bytes", test_bytes },
+		{ "test_ndarray", test_ndarray },
+		{ "test_columns", test_columns },
+		{ "test_json", test_json },
+		{ "test_value", test_value },
 	};
 
 	for (auto const& test : tests)
@@ -55,11 +87,36 @@ void run_tests()
 	}
 }
 
+void run_benchmarks()
+{
+	void benchmark_json();
+
+	std::pair<char const*, void(*)()> benchmarks[] =
+	{
+		{ "benchmark_json", benchmark_json },
+	};
+
+	for (auto const& benchmark : benchmarks)
+	{
+		std::cout << benchmark.first;
+		try
+		{
+			benchmark.second();
+		}
+		catch (std::exception const& ex)
+		{
+			std::cerr << " error: " << ex.what();
+		}
+		std::cout << std::endl;
+	}
+}
+
 int main(int argc, char const * argv[])
 {
 	std::vector<std::string> scripts;
 	std::string lib_path;
 	bool do_tests = false;
+	bool do_benchmarks = false;
 
 	for (int i = 1; i < argc; ++i)
 	{
@@ -72,6 +129,7 @@ int main(int argc, char const * argv[])
 				<< "  --version,-v        Print V8 version\n"
 				<< "  --lib-path <dir>    Set <dir> for plugins library path\n"
 				<< "  --run-tests         Run library tests\n"
+				<< "  --run-benchmarks    Run library benchmarks\n"
 				;
 			return EXIT_SUCCESS;
 		}
@@ -88,6 +146,10 @@ int main(int argc, char const * argv[])
 		{
 			do_tests = true;
 		}
+		else if (arg == "--run-benchmarks")
+		{
+			do_benchmarks = true;
+		}
 		else
 		{
 			scripts.push_back(arg);
@@ -97,10 +159,14 @@ int main(int argc, char const * argv[])
 	v8::V8::InitializeICU();
 	v8::V8::Initialize();
 
-	if (do_tests || scripts.empty())
+	if (do_tests || (scripts.empty() && !do_benchmarks))
 	{
 		run_tests();
 	}
+	if (do_benchmarks)
+	{
+		run_benchmarks();
+	}
 
 	int result = EXIT_SUCCESS;
 	try
@@ -0,0 +1,75 @@
+#include "v8pp/bytes.hpp"
+#include "v8pp/context.hpp"
+#include "v8pp/function.hpp"
+#include "v8pp/pooled_allocator.hpp"
+
+#include "test.hpp"
+
+namespace {
+
+uint8_t const* last_data;
+
+v8pp::bytes make_bytes(int size)
+{
+	v8pp::bytes result;
+	for (int i = 0; i < size; ++i)
+	{
+		result.push_back(static_cast<uint8_t>(i));
+	}
+	last_data = result.data();
+	return result;
+}
+
+size_t sum_bytes(v8pp::bytes_view data)
+{
+	size_t sum = 0;
+	for (uint8_t b : data)
+	{
+		sum += b;
+	}
+	return sum;
+}
+
+} // unnamed namespace
+
+void test_bytes()
+{
+	v8pp::context_options options;
+	options.array_buffer_allocator = &v8pp::pooled_allocator::instance();
+	v8pp::context context(nullptr, options);
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	context.set("make_bytes", v8pp::wrap_function(isolate, "make_bytes", &make_bytes));
+	context.set("sum_bytes", v8pp::wrap_function(isolate, "sum_bytes", &sum_bytes));
+
+	v8::Local<v8::Value> buffer = context.run_script("make_bytes(100)");
+	check("ArrayBuffer", buffer->IsArrayBuffer());
+	check("zero copy", v8pp::from_v8<v8pp::bytes_view>(isolate, buffer).data == last_data);
+	context.set("buffer", buffer);
+	check_eq("ArrayBuffer contents", run_script<int>(context,
+		"var a = new Uint8Array(buffer); a.length + a[99]"), 199);
+
+	check_eq("sum ArrayBuffer", run_script<int>(context, "sum_bytes(buffer)"), 4950);
+	check_eq("sum Uint8Array", run_script<int>(context, "sum_bytes(new Uint8Array([1, 2, 3]))"), 6);
+	check_eq("sum subarray", run_script<int>(context, "sum_bytes(new Uint8Array(buffer, 10, 2))"), 21);
+	check_eq("empty", run_script<int>(context, "make_bytes(0).byteLength"), 0);
+
+	v8pp::bytes const copy = v8pp::from_v8<v8pp::bytes>(isolate, context.run_script("new Uint8Array([7, 8]).buffer"));
+	check_eq("from_v8 copy", copy.size(), 2u);
+	check("from_v8 contents", copy[0] == 7 && copy[1] == 8);
+	v8::Handle<v8::ArrayBuffer> copied = v8pp::to_v8(isolate, copy);
+	check_eq("to_v8 copy", copied->ByteLength(), 2u);
+
+	bool thrown = false;
+	try
+	{
+		v8pp::from_v8<v8pp::bytes_view>(isolate, v8pp::to_v8(isolate, 1));
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("from_v8 number", thrown);
+}
@@ -0,0 +1,44 @@
+#include "v8pp/cached.hpp"
+#include "v8pp/context.hpp"
+
+#include "test.hpp"
+
+#include <map>
+
+void test_cached()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8pp::cached<std::map<std::string, int>> config(std::map<std::string, int>{ { "a", 1 }, { "b", 2 } }, true);
+	check_eq("version", config.version(), 0u);
+
+	v8::Handle<v8::Value> value = v8pp::to_v8(isolate, config);
+	check("same value", v8pp::to_v8(isolate, config) == value);
+	check_eq("cached values", v8pp::detail::cached_values::instance(isolate).size(), 1u);
+
+	context.set("config", value);
+	check_eq("converted", run_script<int>(context, "config.a + config.b"), 3);
+	check("frozen", run_script<bool>(context, "Object.isFrozen(config)"));
+
+	config.update([](std::map<std::string, int>& m) { m["c"] = 3; });
+	check_eq("version after update", config.version(), 1u);
+	v8::Handle<v8::Value> updated = v8pp::to_v8(isolate, config);
+	check("converted again", updated != value);
+	check("same updated value", v8pp::to_v8(isolate, config) == updated);
+	context.set("config", updated);
+	check_eq("updated", run_script<int>(context, "config.c"), 3);
+
+	{
+		v8pp::cached<std::vector<int>> numbers(std::vector<int>{ 1, 2, 3 });
+		context.set("numbers", v8pp::to_v8(isolate, numbers));
+		check_eq("cached values", v8pp::detail::cached_values::instance(isolate).size(), 2u);
+		check("not frozen", !run_script<bool>(context, "Object.isFrozen(numbers)"));
+	}
+	// retired values are dropped on the next conversion
+	config.touch();
+	v8pp::to_v8(isolate, config);
+	check_eq("cached values after retire", v8pp::detail::cached_values::instance(isolate).size(), 1u);
+}
@@ -19,6 +19,29 @@ struct Y : X
 	explicit Y(int x) { var = x; }
 };
 
+struct Z
+{
+	static int instances;
+	int value = 42;
+
+	Z() { ++instances; }
+	~Z() { --instances; }
+
+	int get() const { return value; }
+};
+
+int Z::instances = 0;
+
+struct W
+{
+	static int instances;
+
+	W() { ++instances; }
+	~W() { --instances; }
+};
+
+int W::instances = 0;
+
 namespace v8pp {
 template<>
 struct factory<Y>
@@ -34,7 +57,9 @@ void test_class()
 	v8::Isolate* isolate = context.isolate();
 	v8::HandleScope scope(isolate);
 
+	check("X not bound", !v8pp::class_<X>::is_bound(isolate));
 	v8pp::class_<X> X_class(isolate);
+	check("X bound", v8pp::class_<X>::is_bound(isolate));
 	X_class
 		.ctor()
 		.set_const("konst", 99)
@@ -62,4 +87,66 @@ void test_class()
 	check_eq("X::static_fun(1)", run_script<int>(context, "X.static_fun(3)"), 3);
 
 	check_eq("Y object", run_script<int>(context, "y = new Y(-100); y.konst + y.var"), -1);
+
+	v8pp::class_<Z> Z_class(isolate);
+	Z_class
+		.ctor()
+		.set("get", &Z::get)
+		.set_dispose();
+	context.set("Z", Z_class);
+
+	check_eq("Z created", run_script<int>(context, "z = new Z(); z.get()"), 42);
+	check_eq("Z instances", Z::instances, 1);
+	check("Z dispose", run_script<bool>(context, "z.dispose()"));
+	check_eq("Z destroyed", Z::instances, 0);
+	check("Z dispose twice", !run_script<bool>(context, "z.dispose()"));
+	check("Z method after dispose", run_script<bool>(context,
+		"var thrown = false; try { z.get(); } catch (e) { thrown = true; } thrown"));
+
+	Z ext;
+	context.set("ext", v8pp::class_<Z>::reference_external(isolate, &ext));
+	check("Z external dispose", run_script<bool>(context, "ext.dispose()"));
+	check_eq("Z external not destroyed", Z::instances, 1);
+	check("Z external detached", v8pp::class_<Z>::find_object(isolate, &ext).IsEmpty());
+
+	v8pp::class_<W> W_class(isolate);
+	W_class
+		.ctor()
+		.set_finalization(v8pp::finalization_policy::deferred);
+	context.set("W", W_class);
+
+	run_script<int>(context, "(function() { for (var i = 0; i < 10; ++i) new W(); return 0; })()");
+	check_eq("W instances", W::instances, 10);
+	context.memory_pressure(v8pp::memory_pressure_level::critical);
+	v8pp::finalizer_stats const queued = v8pp::get_finalizer_stats(isolate);
+	check("W finalization queued", queued.queue_depth > 0);
+	check_eq("W not destroyed in GC", W::instances, 10);
+
+	check_eq("W run finalizers", v8pp::run_finalizers(isolate), queued.queue_depth);
+	v8pp::finalizer_stats const finalized = v8pp::get_finalizer_stats(isolate);
+	check_eq("W finalized", finalized.finalized, queued.queue_depth);
+	check_eq("W queue after run", finalized.queue_depth, 0u);
+	check_eq("W destroyed after run", W::instances, 10 - static_cast<int>(queued.queue_depth));
+
+	// queued objects are destroyed with the isolate data
+	{
+		v8pp::context owner;
+		v8::Isolate* owned = owner.isolate();
+		v8::HandleScope owned_scope(owned);
+
+		v8pp::class_<W> owned_W_class(owned);
+		owned_W_class
+			.ctor()
+			.set_finalization(v8pp::finalization_policy::deferred);
+		owner.set("W", owned_W_class);
+
+		run_script<int>(owner, "(function() { for (var i = 0; i < 10; ++i) new W(); return 0; })()");
+		owner.memory_pressure(v8pp::memory_pressure_level::critical);
+		int const instances = W::instances;
+		size_t const queue_depth = v8pp::get_finalizer_stats(owned).queue_depth;
+		check("W owned finalization queued", queue_depth > 0);
+
+		v8pp::release_isolate_data(owned);
+		check_eq("W destroyed on release", W::instances, instances - static_cast<int>(queue_depth));
+	}
 }
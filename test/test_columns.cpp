@@ -0,0 +1,125 @@
+#include "v8pp/columns.hpp"
+#include "v8pp/context.hpp"
+#include "v8pp/pooled_allocator.hpp"
+
+#include "test.hpp"
+
+namespace {
+
+struct trade
+{
+	std::string symbol;
+	double price;
+	int64_t volume;
+	bool buy;
+};
+
+} // unnamed namespace
+
+void test_columns()
+{
+	v8pp::context_options options;
+	options.array_buffer_allocator = &v8pp::pooled_allocator::instance();
+	v8pp::context context(nullptr, options);
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8pp::columns<trade> trade_columns(isolate);
+	trade_columns
+		.field("symbol", &trade::symbol)
+		.field("price", &trade::price)
+		.field("volume", &trade::volume)
+		.field("buy", &trade::buy);
+	check_eq("columns", trade_columns.size(), 4u);
+
+	std::vector<trade> const trades =
+	{
+		{ "AAA", 10.5, 100, true },
+		{ "BBB", 20.25, 200, false },
+		{ "AAA", 11.0, 5000000000, false },
+	};
+
+	context.set("trades", trade_columns.to_v8(trades));
+	check_eq("length", run_script<int>(context, "trades.length"), 3);
+	check("price Float64Array", run_script<bool>(context, "trades.price instanceof Float64Array"));
+	check_eq("price", run_script<double>(context, "trades.price[1]"), 20.25);
+	check_eq("volume", run_script<double>(context, "trades.volume[2]"), 5000000000.0);
+	check("buy Uint8Array", run_script<bool>(context, "trades.buy instanceof Uint8Array && trades.buy[0] == 1"));
+	check_eq("unique strings", run_script<std::string>(context, "trades.symbol.strings.join()"), "AAA,BBB");
+	check_eq("string index", run_script<std::string>(context, "Array.prototype.join.call(trades.symbol.index)"), "0,1,0");
+
+	std::vector<trade> const copy = trade_columns.from_v8(context.run_script("trades").As<v8::Object>());
+	check_eq("from_v8 length", copy.size(), trades.size());
+	for (size_t i = 0; i < copy.size(); ++i)
+	{
+		check_eq("from_v8 symbol", copy[i].symbol, trades[i].symbol);
+		check_eq("from_v8 price", copy[i].price, trades[i].price);
+		check_eq("from_v8 volume", copy[i].volume, trades[i].volume);
+		check_eq("from_v8 buy", copy[i].buy, trades[i].buy);
+	}
+
+	std::vector<trade> const input = trade_columns.from_v8(context.run_script(
+		"({ length: 2, symbol: ['X', 'Y'], price: new Float64Array([1, 2]),"
+		" volume: new Float64Array([3, 4]), buy: new Uint8Array([0, 1]) })").As<v8::Object>());
+	check_eq("input length", input.size(), 2u);
+	check_eq("input symbol", input[1].symbol, "Y");
+	check_eq("input volume", input[1].volume, 4);
+	check("input buy", !input[0].buy && input[1].buy);
+
+	bool thrown = false;
+	try
+	{
+		trade_columns.from_v8(context.run_script(
+			"({ length: 2, symbol: ['X', 'Y'], price: new Float32Array(2),"
+			" volume: new Float64Array(2), buy: new Uint8Array(2) })").As<v8::Object>());
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("wrong column type", thrown);
+
+	thrown = false;
+	try
+	{
+		trade_columns.from_v8(context.run_script("({ length: 1 })").As<v8::Object>());
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("missing column", thrown);
+
+	// a getter of a later column changes already validated ones
+	std::vector<trade> const changed = trade_columns.from_v8(context.run_script(
+		"var symbol = { strings: ['X'], index: new Uint32Array([0, 0]) }, volume = new Float64Array([1, 2]);"
+		"({ length: 2, symbol: symbol, price: new Float64Array(2), volume: volume,"
+		" get buy() { symbol.index[0] = 1e9; volume[1] = NaN; return new Uint8Array(2); } })").As<v8::Object>());
+	check_eq("changed index copied", changed[0].symbol, "X");
+	check_eq("changed value copied", changed[1].volume, 2);
+
+	char const* const invalid[] =
+	{
+		"({ length: 2, symbol: ['X', 'Y'], price: new Float64Array(2), volume: new Float64Array([1, NaN]), buy: new Uint8Array(2) })",
+		"({ length: 2, symbol: ['X', 'Y'], price: new Float64Array(2), volume: new Float64Array([1e19, 0]), buy: new Uint8Array(2) })",
+		"({ length: 2, symbol: ['X', 'Y'], price: new Float64Array(2), volume: new Float64Array(2), buy: new Uint8Array(1) })",
+		"({ length: 4000000000, symbol: [], price: new Float64Array(0), volume: new Float64Array(0), buy: new Uint8Array(0) })",
+	};
+	for (char const* script : invalid)
+	{
+		std::vector<trade> rows = trades;
+		thrown = false;
+		try
+		{
+			trade_columns.from_v8(context.run_script(script).As<v8::Object>(), rows);
+		}
+		catch (std::invalid_argument const&)
+		{
+			thrown = true;
+		}
+		check(script, thrown);
+		check_eq("rows unchanged", rows.size(), trades.size());
+		check_eq("rows unchanged symbol", rows[0].symbol, trades[0].symbol);
+	}
+}
@@ -1,7 +1,153 @@
 #include "v8pp/context.hpp"
+#include "v8pp/function.hpp"
+#include "v8pp/plugin_registry.hpp"
 
 #include "test.hpp"
 
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+bool wait_cancelled(v8::Isolate* isolate)
+{
+	while (!v8pp::context::cancelled(isolate))
+	{
+	}
+	return true;
+}
+
+void check_terminated(v8pp::context& context, char const* script, std::string const& reason)
+{
+	v8::HandleScope scope(context.isolate());
+	v8::TryCatch try_catch;
+	std::string error;
+	try
+	{
+		context.run_script(script);
+	}
+	catch (std::exception const& ex)
+	{
+		error = ex.what();
+	}
+	check_eq(script, error, "script terminated: " + reason);
+	check_eq("run after termination", context.run_script("1")->Int32Value(), 1);
+}
+
+void test_limits()
+{
+	v8pp::context_options options;
+	options.wall_time_limit = std::chrono::milliseconds(100);
+	options.heap_limit = 64 * 1024 * 1024;
+	v8pp::context context(nullptr, options);
+
+	check_terminated(context, "while (true) {}", "wall time limit exceeded");
+	check_terminated(context, "var a = []; while (true) { a.push(new Array(100000)); }", "heap limit exceeded");
+
+	v8::HandleScope scope(context.isolate());
+	context.set("wait_cancelled", v8pp::wrap_function(context.isolate(), "wait_cancelled", &wait_cancelled));
+	check_terminated(context, "wait_cancelled(); while (true) {}", "wall time limit exceeded");
+
+	context.set_time_limits(std::chrono::milliseconds(0), std::chrono::milliseconds(100));
+	check_terminated(context, "while (true) {}", "CPU time limit exceeded");
+}
+
+void test_plugins(v8pp::context& context)
+{
+	v8pp::plugin_registry& registry = v8pp::plugin_registry::instance();
+
+	std::string const filename = std::string("test_plugin_registry") + V8PP_PLUGIN_SUFFIX;
+	std::ofstream(filename.c_str()) << "not a library";
+
+	registry.rescan(".");
+	std::string const found = registry.find(".", "test_plugin_registry");
+	check("plugin found", found.size() > filename.size()
+		&& found.compare(found.size() - filename.size(), filename.size(), filename) == 0);
+	check_eq("plugin found with suffix", registry.find(".", filename), found);
+	check_eq("plugin not found", registry.find(".", "missing_plugin"), "");
+	check_eq("plugin found by path", registry.find("", "./test_plugin_registry"), "./" + filename);
+	// bare names without lib_path are resolved by the dynamic loader, not in the current directory
+	check_eq("invalid library without lib_path", registry.find("", "test_plugin_registry"), "");
+	check_eq("plugin not found without lib_path", registry.find("", "missing_plugin"), "");
+	check_eq("plugin not found by path", registry.find("", "./missing_plugin"), "");
+
+	std::remove(filename.c_str());
+	check_eq("plugin listing cached", registry.find(".", "test_plugin_registry"), found);
+	registry.rescan(".");
+	check_eq("plugin rescan", registry.find(".", "test_plugin_registry"), "");
+
+	v8::HandleScope scope(context.isolate());
+	v8::TryCatch try_catch;
+	context.set_lib_path(".");
+	check("require missing plugin", context.run_script("require('missing_plugin')").IsEmpty());
+	check("require missing plugin throws", try_catch.HasCaught());
+	context.set_lib_path("");
+}
+
+void test_require()
+{
+	std::ofstream("test_module_a.js") << "var b = require('./test_module_b');\n"
+		"exports.value = b.value + 1;\n";
+	std::ofstream("test_module_b.js") << "++evaluated;\n"
+		"module.exports = { value: 41 };\n";
+
+	v8pp::context context;
+	context.set_lib_path(".");
+
+	v8::HandleScope scope(context.isolate());
+	context.run_script("var evaluated = 0");
+	check_eq("require JavaScript module", run_script<int>(context, "require('test_module_a').value"), 42);
+	check("require cached module", run_script<bool>(context,
+		"require('test_module_a.js') === require('./test_module_a')"));
+	check_eq("module evaluated once", run_script<int>(context, "evaluated"), 1);
+	check_eq("C++ require", v8pp::from_v8<int>(context.isolate(),
+		context.require("test_module_b").As<v8::Object>()->Get(v8pp::to_v8(context.isolate(), "value"))), 41);
+
+	// compiled modules are shared by contexts in the isolate
+	std::remove("test_module_a.js");
+	std::remove("test_module_b.js");
+	{
+		v8pp::context context2(context.isolate());
+		context2.set_lib_path(".");
+		context2.run_script("var evaluated = 0");
+		check_eq("require compiled module", run_script<int>(context2, "require('test_module_a').value"), 42);
+		check_eq("module evaluated in context", run_script<int>(context2, "evaluated"), 1);
+	}
+
+	v8::TryCatch try_catch;
+	check("require missing module", context.run_script("require('./missing_module')").IsEmpty());
+	check("require missing module throws", try_catch.HasCaught());
+}
+
+void test_microtasks()
+{
+	v8pp::context_options options;
+	options.microtasks = v8pp::microtask_policy::manual;
+	v8pp::context context(nullptr, options);
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+	context.run_script("var done = 0; function task() { ++done; }");
+	v8::Local<v8::Function> task = context.global()->Get(v8pp::to_v8(isolate, "task")).As<v8::Function>();
+	isolate->EnqueueMicrotask(task);
+	isolate->EnqueueMicrotask(task);
+
+	check_eq("microtasks pending", run_script<int>(context, "done"), 0);
+	context.run_microtasks();
+	check_eq("microtasks run", run_script<int>(context, "done"), 2);
+	check_eq("microtask checkpoints", context.microtask_statistics().checkpoints, 1u);
+	check_eq("microtask checkpoint durations", context.microtask_statistics().duration.count, 1u);
+
+	v8pp::context shared;
+	{
+		v8pp::context manual(shared.isolate(), options);
+		check("manual microtasks", !shared.isolate()->WillAutorunMicrotasks());
+	}
+	check("microtask policy restored", shared.isolate()->WillAutorunMicrotasks());
+}
+
+} // unnamed namespace
+
 void test_context()
 {
 	v8pp::context context;
@@ -9,4 +155,56 @@ void test_context()
 	v8::HandleScope scope(context.isolate());
 	int const r = context.run_script("42")->Int32Value();
 	check_eq("run_script", r, 42);
+
+	char const* filename = "test_context_load_file.js";
+	{
+		std::ofstream file(filename);
+		file << "var a = 40;\na + 2";
+	}
+	v8pp::async_script script = context.load_file(filename);
+	script.wait();
+	check("async_script ready", script.ready());
+	check("async_script compile", script.compile());
+	check_eq("async_script run", script.run()->Int32Value(), 42);
+	std::remove(filename);
+
+	v8pp::async_script missing = context.load_file("missing_file.js");
+	bool thrown = false;
+	try
+	{
+		missing.run();
+	}
+	catch (std::exception const&)
+	{
+		thrown = true;
+	}
+	check("async_script missing file", thrown);
+
+	thrown = false;
+	try
+	{
+		missing.wait();
+	}
+	catch (std::exception const&)
+	{
+		thrown = true;
+	}
+	check("async_script missing file wait", thrown);
+
+	{
+		std::ofstream file(filename);
+		file << "var a = ;";
+	}
+	v8pp::async_script invalid = context.load_file(filename);
+	{
+		v8::TryCatch try_catch;
+		check("async_script invalid compile", !invalid.compile());
+		check("async_script invalid compile again", !invalid.compile());
+	}
+	std::remove(filename);
+
+	test_plugins(context);
+	test_require();
+	test_microtasks();
+	test_limits();
 }
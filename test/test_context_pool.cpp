@@ -0,0 +1,72 @@
+#include "v8pp/context_pool.hpp"
+#include "v8pp/heap_stats.hpp"
+#include "v8pp/isolate_data.hpp"
+
+#include "test.hpp"
+
+void test_context_pool()
+{
+	v8::Isolate* isolate = v8::Isolate::New();
+	isolate->Enter();
+	{
+		v8::HandleScope scope(isolate);
+
+		int init_count = 0;
+		v8pp::context_pool pool(isolate, 2, [&init_count](v8pp::context& ctx)
+			{
+				++init_count;
+				ctx.run_script("var x = 1");
+			});
+		check_eq("initialized contexts", init_count, 2);
+		check_eq("idle contexts", pool.size(), 2u);
+
+		{
+			v8pp::context_pool::lease ctx = pool.acquire();
+			check_eq("idle contexts after acquire", pool.size(), 1u);
+			check_eq("initialized global", run_script<int>(*ctx, "x"), 1);
+			run_script<int>(*ctx, "y = 5; x = 2");
+		}
+		check_eq("idle contexts after release", pool.size(), 2u);
+
+		{
+			v8pp::context_pool::lease ctx = pool.acquire();
+			check_eq("restored global", run_script<int>(*ctx, "x"), 1);
+			check_eq("deleted global", run_script<std::string>(*ctx, "typeof y"), "undefined");
+		}
+
+		v8pp::enable_gc_stats(isolate);
+		{
+			v8pp::context_pool::lease ctx = pool.acquire();
+			check_eq("active contexts", pool.active(), 1u);
+			check("no idle GC with active lease", !pool.idle(std::chrono::milliseconds(10)));
+			run_script<int>(*ctx, "var a = []; for (var i = 0; i < 100000; ++i) a.push({}); a = null; 0");
+		}
+		check_eq("active contexts before idle GC", pool.active(), 0u);
+		v8pp::reset_gc_stats(isolate);
+		size_t const used_size = v8pp::get_heap_stats(isolate).used_heap_size;
+		for (int i = 0; i < 100 && !pool.idle(std::chrono::milliseconds(100)); ++i)
+		{
+		}
+		v8pp::gc_stats const gc = v8pp::get_gc_stats(isolate);
+		check("idle GC done", gc.scavenge_count + gc.mark_sweep_count > 0);
+		check("idle GC reclaimed", v8pp::get_heap_stats(isolate).used_heap_size < used_size);
+		v8pp::disable_gc_stats(isolate);
+
+		pool.set_max_uses(1);
+		{
+			v8pp::context_pool::lease ctx = pool.acquire();
+		}
+		check_eq("discarded context", pool.size(), 1u);
+
+		{
+			v8pp::context_pool::lease ctx1 = pool.acquire();
+			v8pp::context_pool::lease ctx2 = pool.acquire();
+			check_eq("created on demand", init_count, 3);
+			ctx2.discard();
+		}
+		check_eq("discarded after max uses", pool.size(), 0u);
+	}
+	v8pp::release_isolate_data(isolate);
+	isolate->Exit();
+	isolate->Dispose();
+}
@@ -0,0 +1,62 @@
+#include "v8pp/handle_table.hpp"
+#include "v8pp/class.hpp"
+#include "v8pp/context.hpp"
+
+#include "test.hpp"
+
+namespace {
+
+struct item
+{
+	int value;
+	explicit item(int value) : value(value) {}
+};
+
+} // unnamed namespace
+
+void test_handle_table()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8pp::handle_table& table = v8pp::handle_table::instance(isolate);
+	check("find table", v8pp::handle_table::find(isolate) == &table);
+
+	v8pp::handle_ref const a = table.add(v8pp::to_v8(isolate, "a"));
+	v8pp::handle_ref const b = table.add(v8pp::to_v8(isolate, 42));
+	check_eq("size", table.size(), 2u);
+	check_eq("get a", v8pp::from_v8<std::string>(isolate, table.get(a)), "a");
+	check_eq("get b", v8pp::from_v8<int>(isolate, table.get(b)), 42);
+
+	check("remove a", table.remove(a));
+	check("remove a twice", !table.remove(a));
+	check("stale a", table.get(a).IsEmpty());
+	check("empty ref", table.get(v8pp::handle_ref()).IsEmpty());
+
+	v8pp::handle_ref const c = table.add(v8pp::to_v8(isolate, "c"));
+	check_eq("slot reused", c.index, a.index);
+	check("new generation", c != a);
+	check("stale a after reuse", !table.contains(a));
+	check_eq("get c", v8pp::from_v8<std::string>(isolate, table.get(c)), "c");
+	check_eq("capacity", table.capacity(), 2u);
+
+	v8pp::class_<item> item_class(isolate);
+	item_class
+		.ctor<int>()
+		.set("value", &item::value);
+	context.set("item", item_class);
+
+	v8pp::table_ptr<item> ptr(isolate, context.run_script("new item(10)"));
+	check("ptr", ptr && ptr->value == 10);
+	check_eq("ptr retained", table.size(), 3u);
+	check("ptr value", v8pp::from_v8<item*>(isolate, table.get(ptr.ref())) == ptr.get());
+
+	v8pp::table_ptr<item> moved(std::move(ptr));
+	check("moved from", !ptr);
+	check_eq("moved value", moved->value, 10);
+
+	moved.reset();
+	check_eq("ptr released", table.size(), 2u);
+}
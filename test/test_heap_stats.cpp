@@ -0,0 +1,45 @@
+#include "v8pp/heap_stats.hpp"
+#include "v8pp/context.hpp"
+
+#include "test.hpp"
+
+void test_heap_stats()
+{
+	v8pp::histogram hist;
+	hist.add(0);
+	hist.add(1);
+	hist.add(5);
+	hist.add(7);
+	check_eq("histogram count", hist.count, 4u);
+	check_eq("histogram sum", hist.sum, 13u);
+	check_eq("histogram max", hist.max, 7u);
+	check_eq("histogram zero bucket", hist.buckets[0], 1u);
+	check_eq("histogram [1, 2) bucket", hist.buckets[1], 1u);
+	check_eq("histogram [4, 8) bucket", hist.buckets[3], 2u);
+
+	v8pp::context_options options;
+	options.gc_stats = true;
+	v8pp::context context(nullptr, options);
+	v8::Isolate* isolate = context.isolate();
+	v8::HandleScope scope(isolate);
+
+	v8pp::heap_stats const heap = context.heap_statistics();
+	check("used heap size", heap.used_heap_size > 0);
+	check("heap size limit", heap.heap_size_limit >= heap.used_heap_size);
+
+	check_eq("no GC yet", context.gc_statistics().mark_sweep_count, 0u);
+	run_script<int>(context, "var a = []; for (var i = 0; i < 1000; ++i) a.push(new Array(1000)); a = null; 0");
+	context.memory_pressure(v8pp::memory_pressure_level::critical);
+
+	v8pp::gc_stats const gc = context.gc_statistics();
+	check("mark-sweep count", gc.mark_sweep_count > 0);
+	check_eq("pause count", gc.pause.count, gc.scavenge_count + gc.mark_sweep_count);
+
+	v8pp::module stats = v8pp::stats_module(isolate);
+	context.set("stats", stats);
+	check("JS heap stats", run_script<bool>(context, "stats.heap.used_heap_size > 0"));
+	check_eq("JS GC stats", run_script<uint64_t>(context, "stats.gc.mark_sweep_count"), gc.mark_sweep_count);
+
+	v8pp::reset_gc_stats(isolate);
+	check_eq("reset GC stats", context.gc_statistics().pause.count, 0u);
+}
@@ -0,0 +1,46 @@
+#include "v8pp/isolate_pool.hpp"
+
+#include "test.hpp"
+
+#include <vector>
+
+void test_isolate_pool()
+{
+	v8pp::isolate_pool pool(2, [](v8pp::context& ctx)
+		{
+			ctx.run_script("var base = 40");
+		});
+	check_eq("pool size", pool.size(), 2u);
+
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 10; ++i)
+	{
+		results.emplace_back(pool.submit([i](v8pp::context& ctx)
+			{
+				return run_script<int>(ctx, "base + 2") + i;
+			}));
+	}
+	for (int i = 0; i < 10; ++i)
+	{
+		check_eq("submit result", results[i].get(), 42 + i);
+	}
+
+	// jobs are picked up by workers doing idle GC
+	pool.set_idle_gc(std::chrono::milliseconds(5));
+	check_eq("idle GC", pool.idle_gc().count(), 5);
+	check_eq("run_script after idle GC", pool.run_script("base").get(), "40");
+	check_eq("run_script during idle GC", pool.run_script("base + 1").get(), "41");
+
+	check_eq("run_script JSON", pool.run_script("[base, { a: 'b' }]").get(), "[40,{\"a\":\"b\"}]");
+
+	bool thrown = false;
+	try
+	{
+		pool.run_script("throw new Error('fail')").get();
+	}
+	catch (std::runtime_error const&)
+	{
+		thrown = true;
+	}
+	check("run_script exception", thrown);
+}
@@ -0,0 +1,140 @@
+#include "v8pp/context.hpp"
+#include "v8pp/json.hpp"
+
+#include "test.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+void test_json()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	using matrix = std::vector<std::vector<double>>;
+	using table = std::map<std::string, std::vector<int>>;
+
+	check_eq("to_json numbers", v8pp::to_json(std::vector<double>{ 1, -2.5, NAN }), "[1,-2.5,null]");
+	check_eq("to_json string", v8pp::to_json(std::string("a\"b\\\n\x01")), "\"a\\\"b\\\\\\n\\u0001\"");
+	check_eq("to_json map", v8pp::to_json(table{ { "a", { 1 } }, { "b", {} } }), "{\"a\":[1],\"b\":[]}");
+
+	matrix const m = v8pp::from_json<matrix>(" [[1, 2.5e1], [-3.25, 1e-2]] ");
+	check_eq("from_json rows", m.size(), 2u);
+	check_eq("from_json [0][1]", m[0][1], 25.0);
+	check_eq("from_json [1][0]", m[1][0], -3.25);
+	check_eq("from_json unicode", v8pp::from_json<std::string>("\"\\u00e9\\ud83d\\ude00\""),
+		"\xC3\xA9\xF0\x9F\x98\x80");
+	check("from_json null", std::isnan(v8pp::from_json<double>("null")));
+	check_eq("from_json long integer", v8pp::from_json<double>("123456789012345678901234567890"), 1.2345678901234568e29);
+
+	bool thrown = false;
+	try
+	{
+		v8pp::from_json<std::vector<int>>("[1, 2");
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("from_json invalid", thrown);
+
+	v8pp::bulk_options always;
+	always.mode = v8pp::bulk_mode::always;
+	v8pp::bulk_options never;
+	never.mode = v8pp::bulk_mode::never;
+
+	matrix big(100, std::vector<double>(10, 0.5));
+	big[99][9] = 1.25;
+	check_eq("bulk_size", v8pp::detail::bulk_size(big), 1000u);
+
+	for (v8pp::bulk_options const& options : { always, never, v8pp::bulk_options() })
+	{
+		context.set("big", v8pp::to_v8_bulk(isolate, big, options));
+		check_eq("to_v8_bulk", run_script<double>(context, "big.length * big[0].length + big[99][9]"), 1001.25);
+
+		matrix const back = v8pp::from_v8_bulk<matrix>(isolate, context.run_script("big"), options);
+		check("from_v8_bulk", back == big);
+	}
+
+	check_eq("bulk_size cyclic", v8pp::detail::bulk_size(isolate,
+		context.run_script("var a = [1, 2]; a[0] = a; a"), v8pp::detail::bulk_depth<matrix>::value), 4u);
+
+	table const t = { { "x", { 1, 2, 3 } }, { "y", { -4 } } };
+	context.set("t", v8pp::to_v8_bulk(isolate, t, always));
+	check_eq("to_v8_bulk map", run_script<int>(context, "t.x[2] + t.y[0]"), -1);
+	check("from_v8_bulk map", v8pp::from_v8_bulk<table>(isolate, context.run_script("t"), always) == t);
+}
+
+namespace {
+
+template<typename F>
+double measure_us(int repeat, F f)
+{
+	auto const start = std::chrono::steady_clock::now();
+	for (int i = 0; i < repeat; ++i)
+	{
+		f();
+	}
+	std::chrono::duration<double, std::micro> const elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / repeat;
+}
+
+} // unnamed namespace
+
+void benchmark_json()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8pp::bulk_options bulk;
+	bulk.mode = v8pp::bulk_mode::always;
+	v8pp::bulk_options per_element;
+	per_element.mode = v8pp::bulk_mode::never;
+
+	std::cout << "\nstd::vector<std::vector<double>> conversion, microseconds per call\n"
+		<< std::setw(10) << "elements"
+		<< std::setw(14) << "to_v8" << std::setw(14) << "to_v8 JSON"
+		<< std::setw(14) << "from_v8" << std::setw(14) << "from_v8 JSON" << '\n';
+
+	for (size_t size = 4; size <= 65536; size *= 4)
+	{
+		size_t const cols = size < 16? size : 16;
+		std::vector<std::vector<double>> const value(size / cols, std::vector<double>(cols, 3.25));
+		int const repeat = static_cast<int>(1 + 200000 / size);
+		v8::HandleScope size_scope(isolate);
+
+		double const to_v8_time = measure_us(repeat, [&]()
+			{
+				v8::HandleScope scope(isolate);
+				v8pp::to_v8_bulk(isolate, value, per_element);
+			});
+		double const to_v8_json_time = measure_us(repeat, [&]()
+			{
+				v8::HandleScope scope(isolate);
+				v8pp::to_v8_bulk(isolate, value, bulk);
+			});
+
+		v8::Local<v8::Value> js_value = v8pp::to_v8_bulk(isolate, value, bulk);
+		double const from_v8_time = measure_us(repeat, [&]()
+			{
+				v8::HandleScope scope(isolate);
+				v8pp::from_v8_bulk<std::vector<std::vector<double>>>(isolate, js_value, per_element);
+			});
+		double const from_v8_json_time = measure_us(repeat, [&]()
+			{
+				v8::HandleScope scope(isolate);
+				v8pp::from_v8_bulk<std::vector<std::vector<double>>>(isolate, js_value, bulk);
+			});
+
+		std::cout << std::setw(10) << size << std::fixed << std::setprecision(2)
+			<< std::setw(14) << to_v8_time << std::setw(14) << to_v8_json_time
+			<< std::setw(14) << from_v8_time << std::setw(14) << from_v8_json_time << '\n';
+	}
+	std::cout << "default bulk_options::threshold is " << v8pp::bulk_options().threshold << std::endl;
+}
@@ -12,6 +12,15 @@ static int x = 1;
 static int get_x() { return x + 1; }
 static void set_x(int v) { x = v - 1; }
 
+static int lazy_count = 0;
+static v8::Handle<v8::Value> lazy_value(v8::Isolate* isolate)
+{
+	++lazy_count;
+	v8pp::module lazy(isolate);
+	lazy.set_const("answer", 42);
+	return lazy.new_instance();
+}
+
 void test_module()
 {
 	v8pp::context context;
@@ -36,6 +45,7 @@ void test_module()
 		.set("empty", v8::Null(context.isolate()))
 		.set("rprop", v8pp::property(get_x))
 		.set("wprop", v8pp::property(get_x, set_x))
+		.set_lazy("lazy", &lazy_value)
 		;
 	context.set("module", module);
 
@@ -52,4 +62,9 @@ void test_module()
 	check_eq("module.rprop", run_script<int>(context, "module.rprop"), 2);
 	check_eq("module.wrop", run_script<int>(context, "++module.wprop"), 3);
 	check_eq("x", x, 2);
+
+	check_eq("lazy not created", lazy_count, 0);
+	check_eq("module.lazy", run_script<int>(context, "module.lazy.answer"), 42);
+	check_eq("module.lazy again", run_script<bool>(context, "module.lazy === module.lazy"), true);
+	check_eq("lazy created once", lazy_count, 1);
 }
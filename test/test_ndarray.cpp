@@ -0,0 +1,139 @@
+#include "v8pp/context.hpp"
+#include "v8pp/function.hpp"
+#include "v8pp/ndarray.hpp"
+#include "v8pp/pooled_allocator.hpp"
+
+#include "test.hpp"
+
+namespace {
+
+double const* last_data;
+
+v8pp::ndarray<double> make_matrix(int rows, int cols)
+{
+	v8pp::ndarray<double> result({ size_t(rows), size_t(cols) });
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int j = 0; j < cols; ++j)
+		{
+			result.at({ size_t(i), size_t(j) }) = i * 10 + j;
+		}
+	}
+	last_data = result.data();
+	return result;
+}
+
+double trace(v8pp::ndarray<double> const& m)
+{
+	double sum = 0;
+	for (size_t i = 0; i < m.shape()[0] && i < m.shape()[1]; ++i)
+	{
+		sum += m.at({ i, i });
+	}
+	return sum;
+}
+
+double element(v8pp::ndarray<int32_t> const& m, int i, int j)
+{
+	return m.at({ size_t(i), size_t(j) });
+}
+
+} // unnamed namespace
+
+void test_ndarray()
+{
+	v8pp::context_options options;
+	options.array_buffer_allocator = &v8pp::pooled_allocator::instance();
+	v8pp::context context(nullptr, options);
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	context.set("make_matrix", v8pp::wrap_function(isolate, "make_matrix", &make_matrix));
+	context.set("trace", v8pp::wrap_function(isolate, "trace", &trace));
+	context.set("element", v8pp::wrap_function(isolate, "element", &element));
+
+	v8::Local<v8::Value> m = context.run_script("m = make_matrix(3, 4)");
+	check("Float64Array data", run_script<bool>(context, "m.data instanceof Float64Array"));
+	check_eq("shape", run_script<std::string>(context, "m.shape.join()"), "3,4");
+	check_eq("strides", run_script<std::string>(context, "m.strides.join()"), "4,1");
+	check_eq("element(2, 3)", run_script<int>(context, "m.data[2 * m.strides[0] + 3 * m.strides[1]]"), 23);
+	check("zero copy result", v8pp::from_v8<v8pp::ndarray<double>>(isolate, m).data() == last_data);
+
+	check_eq("trace", run_script<int>(context, "trace(m)"), 11);
+	check_eq("trace row-major", run_script<int>(context,
+		"trace({ data: new Float64Array([1, 2, 3, 4]), shape: [2, 2] })"), 5);
+	check_eq("column-major", run_script<int>(context,
+		"element({ data: new Int32Array([1, 2, 3, 4, 5, 6]), shape: [2, 3], order: 'F' }, 1, 0)"), 2);
+	check_eq("row-major", run_script<int>(context,
+		"element({ data: new Int32Array([1, 2, 3, 4, 5, 6]), shape: [2, 3] }, 1, 0)"), 4);
+
+	double external[6] = { 1, 2, 3, 4, 5, 6 };
+	v8pp::ndarray<double> const view = v8pp::ndarray<double>::view(external, { 2, 3 }, v8pp::array_order::column_major);
+	check("view not owning", !view.owns_data());
+	check("view column-major", view.is_contiguous(v8pp::array_order::column_major));
+	check_eq("view element", view.at({ 0, 1 }), 3.0);
+	context.set("view", v8pp::to_v8(isolate, view));
+	run_script<int>(context, "view.data[1] = 20; 0");
+	check_eq("view zero copy", external[1], 20.0);
+
+	v8pp::ndarray<double> const transposed = v8pp::ndarray<double>::view(view.data(), { 3, 2 }, { 2, 1 });
+	check_eq("transposed", transposed.at({ 1, 0 }), 3.0);
+
+	v8pp::ndarray<double> const copy = make_matrix(2, 2);
+	v8pp::ndarray<double> copy2 = copy;
+	check("copied storage", copy2.data() != copy.data() && copy2.at({ 1, 1 }) == 11);
+
+	double const* const copy2_data = copy2.data();
+	v8pp::ndarray<double> moved = std::move(copy2);
+	check("moved storage", moved.data() == copy2_data && moved.at({ 1, 1 }) == 11);
+	check("moved from empty", copy2.data() == nullptr && copy2.shape().empty() && !copy2.owns_data());
+	copy2 = std::move(moved);
+	check("move assigned", copy2.data() == copy2_data && moved.data() == nullptr && moved.strides().empty());
+
+	bool thrown = false;
+	try
+	{
+		run_script<int>(context, "trace({ data: new Float64Array(3), shape: [2, 2] })");
+	}
+	catch (std::exception const&)
+	{
+		thrown = true;
+	}
+	check("data too short", thrown);
+
+	thrown = false;
+	try
+	{
+		run_script<int>(context, "element({ data: new Float64Array(4), shape: [2, 2] }, 0, 0)");
+	}
+	catch (std::exception const&)
+	{
+		thrown = true;
+	}
+	check("data type mismatch", thrown);
+
+	thrown = false;
+	try
+	{
+		run_script<int>(context, "trace({ data: new Float64Array(4),"
+			" shape: [2147483649, 2147483649, 2147483649, 2147483649],"
+			" strides: [2147483648, 2147483648, 2147483648, 2147483648] })");
+	}
+	catch (std::exception const&)
+	{
+		thrown = true;
+	}
+	check("span overflow", thrown);
+
+	thrown = false;
+	try
+	{
+		run_script<int>(context, "trace({ data: new Float64Array(4), shape: [4194304, 4194304, 4194304] })");
+	}
+	catch (std::exception const&)
+	{
+		thrown = true;
+	}
+	check("element count overflow", thrown);
+}
@@ -33,3 +33,52 @@ void test_object()
 	check("get obj.pi", v8pp::get_option(isolate, obj, "pi", pi));
 	check("obj.pi", abs(pi - 3.1415926) < 10e-6);
 }
+
+void test_option_path()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8::Local<v8::Object> obj = context.run_script(
+		"({ db: { host: 'localhost', pool: { min: 1, max: 10 } }, debug: true })").As<v8::Object>();
+
+	v8pp::option_path const max_path(isolate, "db.pool.max");
+	check_eq("segments", max_path.size(), 3u);
+	check_eq("name", max_path.name(), "db.pool.max");
+
+	int max = 0;
+	check("get db.pool.max", max_path.get(obj, max));
+	check_eq("db.pool.max", max, 10);
+	check("set db.pool.max", max_path.set(obj, 20));
+	check("get db.pool.max after set", v8pp::get_option(isolate, obj, "db.pool.max", max));
+	check_eq("db.pool.max after set", max, 20);
+
+	v8pp::option_path const missing(isolate, "db.cache.size");
+	check("get missing", !missing.get(obj, max));
+	check("set missing", !missing.set(obj, 1));
+
+	{
+		v8::TryCatch try_catch;
+		v8::Local<v8::Object> throwing = context.run_script(
+			"({ get db() { throw new Error('getter'); } })").As<v8::Object>();
+		check("get throwing", !max_path.get(throwing, max));
+		check("get throwing exception", try_catch.HasCaught());
+	}
+
+	v8pp::option_paths const paths(isolate, { "db.pool.min", "db.pool.max", "db.host", "db.cache.size", "debug" });
+	check_eq("shared db.pool", paths.shared_prefix(1), 2u);
+	check_eq("shared db", paths.shared_prefix(2), 1u);
+	check_eq("shared none", paths.shared_prefix(4), 0u);
+
+	int min = 0, size = 0;
+	std::string host;
+	bool debug = false;
+	check_eq("get_options found", v8pp::get_options(obj, paths, min, max, host, size, debug), 4u);
+	check_eq("min", min, 1);
+	check_eq("max", max, 20);
+	check_eq("host", host, "localhost");
+	check_eq("size not found", size, 0);
+	check_eq("debug", debug, true);
+}
@@ -0,0 +1,47 @@
+#include "v8pp/persistent.hpp"
+#include "v8pp/context.hpp"
+
+#include "test.hpp"
+
+void test_weak_cache()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8pp::weak_cache<int, v8::Object> cache(isolate);
+	check("miss", cache.get(1).IsEmpty());
+
+	v8::Local<v8::Object> kept = v8::Object::New(isolate);
+	cache.set(1, kept);
+	check("hit", cache.get(1) == kept);
+
+	int created = 0;
+	auto create = [isolate, &created]()
+		{
+			++created;
+			return v8::Object::New(isolate);
+		};
+	{
+		v8::HandleScope inner_scope(isolate);
+		cache.get_or_create(2, create);
+		cache.get_or_create(2, create);
+	}
+	check_eq("created once", created, 1);
+	check_eq("size", cache.size(), 2u);
+
+	v8pp::weak_cache<int, v8::Object>::stats stats = cache.statistics();
+	check_eq("hits", stats.hits, 2u);
+	check_eq("misses", stats.misses, 2u);
+
+	context.memory_pressure(v8pp::memory_pressure_level::critical);
+	check_eq("size after GC", cache.size(), 1u);
+	check_eq("evictions", cache.statistics().evictions, 1u);
+	check("kept after GC", cache.get(1) == kept);
+	check("collected", cache.get(2).IsEmpty());
+
+	check("erase", cache.erase(1));
+	check("erase missing", !cache.erase(1));
+	check_eq("empty", cache.size(), 0u);
+}
@@ -0,0 +1,50 @@
+#include "v8pp/pooled_allocator.hpp"
+#include "v8pp/context.hpp"
+
+#include "test.hpp"
+
+#include <cstring>
+
+void test_pooled_allocator()
+{
+	v8pp::pooled_allocator::options options;
+	options.max_pooled_size = 64 * 1024;
+	options.max_cached_size = 256 * 1024;
+	v8pp::pooled_allocator allocator(options);
+
+	size_t const size = 64 * 1024;
+	void* data = allocator.AllocateUninitialized(size);
+	check("allocated", data != nullptr);
+	std::memset(data, 0xAB, size);
+	allocator.Free(data, size);
+	check_eq("cached size", allocator.statistics().cached_size, size);
+
+	unsigned char* zeroed = static_cast<unsigned char*>(allocator.Allocate(size));
+	check_eq("reused", allocator.statistics().reused, 1u);
+	check("zero-filled", zeroed[0] == 0 && zeroed[size / 2] == 0 && zeroed[size - 1] == 0);
+	check_eq("allocated size", allocator.statistics().allocated_size, size);
+	allocator.Free(zeroed, size);
+
+	void* large = allocator.Allocate(4 * size);
+	check_eq("large allocated size", allocator.statistics().allocated_size, 4 * size);
+	allocator.Free(large, 4 * size);
+	check_eq("large not cached", allocator.statistics().cached_size, size);
+
+	allocator.trim();
+	v8pp::pooled_allocator::stats const stats = allocator.statistics();
+	check_eq("trimmed", stats.cached_size, 0u);
+	check_eq("allocations", stats.allocations, 3u);
+	check_eq("frees", stats.frees, 3u);
+	check_eq("no allocated size", stats.allocated_size, 0u);
+
+	v8pp::pooled_allocator& shared_allocator = v8pp::pooled_allocator::instance();
+	v8pp::context_options context_options;
+	context_options.array_buffer_allocator = &shared_allocator;
+	v8pp::context context(nullptr, context_options);
+	check("context allocator", v8pp::context::array_buffer_allocator() == &shared_allocator);
+
+	v8::HandleScope scope(context.isolate());
+	uint64_t const allocations = shared_allocator.statistics().allocations;
+	check_eq("ArrayBuffer", run_script<int>(context, "new ArrayBuffer(65536).byteLength"), 65536);
+	check("ArrayBuffer allocation", shared_allocator.statistics().allocations > allocations);
+}
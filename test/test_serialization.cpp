@@ -0,0 +1,113 @@
+#include "v8pp/serialization.hpp"
+#include "v8pp/bytes.hpp"
+#include "v8pp/class.hpp"
+#include "v8pp/context.hpp"
+#include "v8pp/pooled_allocator.hpp"
+
+#include "test.hpp"
+
+namespace {
+
+struct point
+{
+	int x, y;
+};
+
+v8pp::context_options serialization_options()
+{
+	v8pp::context_options options;
+	options.array_buffer_allocator = &v8pp::pooled_allocator::instance();
+	return options;
+}
+
+template<typename T>
+T deserialized(v8pp::context& context, v8::Handle<v8::Value> value, char const* script)
+{
+	context.set("value", value);
+	return run_script<T>(context, script);
+}
+
+template<typename Func>
+bool throws(Func func)
+{
+	try
+	{
+		func();
+	}
+	catch (std::runtime_error const&)
+	{
+		return true;
+	}
+	return false;
+}
+
+} // unnamed namespace
+
+void test_serialization()
+{
+	point pt = { 1, 2 };
+	v8pp::serialized_value value, transferred;
+
+	{
+		v8pp::context context(nullptr, serialization_options());
+		v8::Isolate* isolate = context.isolate();
+		v8::HandleScope scope(isolate);
+
+		v8pp::class_<point> point_class(isolate);
+		point_class.set("x", &point::x);
+		context.set("pt", v8pp::class_<point>::reference_external(isolate, &pt));
+
+		v8::Local<v8::Value> obj = context.run_script(
+			"var obj = { num: 42, neg: -7, pi: 3.5, str: 'h\\u00e9llo', date: new Date(1000),"
+			" arr: [1, null, undefined, true, false], bytes: new Uint16Array([1, 2, 3]).subarray(1) };"
+			"obj.self = obj; obj.same = obj.arr; obj");
+		value = v8pp::serialize(isolate, obj);
+		check_eq("no transfers", value.transferred_count(), 0u);
+
+		v8::Local<v8::ArrayBuffer> buffer = context.run_script(
+			"var buf = new Uint8Array([10, 20, 30]).buffer; buf").As<v8::ArrayBuffer>();
+		transferred = v8pp::serialize(isolate, context.run_script("({ buf: buf, view: new Uint8Array(buf, 1) })"),
+			std::vector<v8::Local<v8::ArrayBuffer>>{ buffer });
+		check_eq("transferred", transferred.transferred_count(), 1u);
+		check_eq("source neutered", run_script<int>(context, "buf.byteLength"), 0);
+
+		check("serialize function", throws([&]()
+		{
+			v8pp::serialize(isolate, context.run_script("({ f: function() {} })"));
+		}));
+		check("transfer external buffer", throws([&]()
+		{
+			v8::Local<v8::ArrayBuffer> external = v8pp::detail::vector_array_buffer(isolate, std::vector<uint8_t>(16));
+			v8pp::serialize(isolate, external, std::vector<v8::Local<v8::ArrayBuffer>>{ external });
+		}));
+		check("serialize host object", throws([&]()
+		{
+			v8pp::serialize(isolate, context.run_script("({ pt: pt })"));
+		}));
+	}
+
+	v8pp::context context(nullptr, serialization_options());
+	v8::Isolate* isolate = context.isolate();
+	v8::HandleScope scope(isolate);
+
+	v8::Handle<v8::Value> obj = v8pp::deserialize(isolate, value);
+	check_eq("int", deserialized<int>(context, obj, "value.num + value.neg"), 35);
+	check_eq("double", deserialized<double>(context, obj, "value.pi"), 3.5);
+	check_eq("string", deserialized<std::string>(context, obj, "value.str"), "h\xC3\xA9llo");
+	check_eq("date", deserialized<double>(context, obj, "value.date.getTime()"), 1000.0);
+	check_eq("array", deserialized<std::string>(context, obj, "JSON.stringify(value.arr)"),
+		"[1,null,null,true,false]");
+	check_eq("typed array", deserialized<std::string>(context, obj,
+		"value.bytes.length + ':' + value.bytes[0] + ':' + value.bytes.buffer.byteLength"), "2:2:6");
+	check("circular reference", deserialized<bool>(context, obj, "value.self === value"));
+	check("shared reference", deserialized<bool>(context, obj, "value.same === value.arr"));
+
+	v8::Handle<v8::Value> moved = v8pp::deserialize(isolate, transferred);
+	check_eq("transferred taken", transferred.transferred_count(), 0u);
+	check_eq("transferred buffer", deserialized<std::string>(context, moved,
+		"Array.prototype.join.call(new Uint8Array(value.buf)) + ':' + value.view[0]"), "10,20,30:20");
+	check("deserialize transferred twice", throws([&]()
+	{
+		v8pp::deserialize(isolate, transferred);
+	}));
+}
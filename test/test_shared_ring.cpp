@@ -0,0 +1,97 @@
+#include "v8pp/shared_ring.hpp"
+#include "v8pp/context.hpp"
+#include "v8pp/function.hpp"
+#include "v8pp/pooled_allocator.hpp"
+
+#include "test.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace {
+
+struct point
+{
+	float x, y;
+};
+
+std::chrono::steady_clock::time_point wait_deadline;
+
+// let the producer thread run, false on timeout
+bool wait_records()
+{
+	std::this_thread::yield();
+	return std::chrono::steady_clock::now() < wait_deadline;
+}
+
+} // unnamed namespace
+
+namespace v8pp {
+
+template<>
+struct record_layout<point>
+{
+	using element_type = float;
+	enum { count = 2 };
+};
+
+} // namespace v8pp
+
+void test_shared_ring()
+{
+	v8pp::context_options options;
+	options.array_buffer_allocator = &v8pp::pooled_allocator::instance();
+	v8pp::context context(nullptr, options);
+	v8::HandleScope scope(context.isolate());
+
+	v8pp::shared_ring<point> points(context.isolate(), 3);
+	check_eq("capacity", points.capacity(), 4u);
+	check("push", points.try_push(point{ 1.5f, 2.5f }));
+	check("push", points.try_push(point{ 3.0f, 4.0f }));
+	check_eq("size", points.size(), 2u);
+
+	point pt;
+	check("pop", points.try_pop(pt));
+	check("pop record", pt.x == 1.5f && pt.y == 2.5f);
+
+	context.set("points", points.js_object());
+	check_eq("JS record", run_script<double>(context,
+		"var h = points.header, i = (h[16] & (points.capacity - 1)) * points.record_length;"
+		"h[16] = (h[16] + 1) | 0; points.records[i] + points.records[i + 1]"), 7.0);
+	check_eq("size after JS pop", points.size(), 0u);
+	check("empty", !points.try_pop(pt));
+
+	for (int i = 0; i < 4; ++i)
+	{
+		check("push", points.try_push(point{ float(i), 0.0f }));
+	}
+	check("full", !points.try_push(point{ 0.0f, 0.0f }));
+
+	// stream records from a C++ thread, JavaScript consumes them
+	int const count = 1000;
+	v8pp::shared_ring<int32_t> numbers(context.isolate(), 16);
+	std::thread producer([&numbers]()
+		{
+			for (int32_t i = 1; i <= count; ++i)
+			{
+				while (!numbers.try_push(i))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	context.set("numbers", numbers.js_object());
+
+	// JavaScript polls an empty ring through a call to C++, with a timeout
+	wait_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	context.set("wait_records", v8pp::wrap_function(context.isolate(), "wait_records", &wait_records));
+	double const sum = run_script<double>(context,
+		"var h = numbers.header, mask = numbers.capacity - 1, n = 0, sum = 0;"
+		"while (n < 1000) {"
+		"  if (h[0] === h[16]) { if (wait_records()) continue; break; }"
+		"  sum += numbers.records[h[16] & mask]; h[16] = (h[16] + 1) | 0; ++n;"
+		"}"
+		"sum");
+	producer.join();
+	check_eq("streamed records", sum, count * (count + 1) / 2.0);
+}
@@ -0,0 +1,77 @@
+#include "v8pp/struct_options.hpp"
+#include "v8pp/context.hpp"
+
+#include "test.hpp"
+
+namespace {
+
+struct db_options
+{
+	std::string host;
+	int port;
+	bool debug;
+	double timeout;
+	std::vector<std::string> tables;
+};
+
+} // unnamed namespace
+
+void test_struct_options()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8pp::struct_options<db_options> fields(isolate);
+	fields
+		.field("host", &db_options::host, "localhost")
+		.field("port", &db_options::port, 5432)
+		.field("debug", &db_options::debug, false)
+		.field("timeout", &db_options::timeout, 1.5)
+		.field("tables", &db_options::tables);
+	check_eq("fields", fields.size(), 5u);
+
+	db_options opts = fields.get(context.run_script(
+		"({ port: 1234, debug: true, tables: ['a', 'b'] })").As<v8::Object>());
+	check_eq("host default", opts.host, "localhost");
+	check_eq("port", opts.port, 1234);
+	check_eq("debug", opts.debug, true);
+	check_eq("timeout default", opts.timeout, 1.5);
+	check_eq("tables", opts.tables, std::vector<std::string>{ "a", "b" });
+
+	std::vector<std::string> unknown;
+	fields.get(context.run_script("({ host: 'db', prot: 1, 0: 'x', timeout: undefined })").As<v8::Object>(),
+		opts, &unknown);
+	check_eq("host", opts.host, "db");
+	check_eq("port default", opts.port, 5432);
+	check_eq("timeout undefined", opts.timeout, 1.5);
+	check("tables default", opts.tables.empty());
+	check_eq("unknown", unknown.size(), 2u);
+	check("unknown names", (unknown[0] == "0" && unknown[1] == "prot") || (unknown[0] == "prot" && unknown[1] == "0"));
+
+	bool thrown = false;
+	try
+	{
+		fields.field("port", &db_options::port);
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("duplicate field", thrown);
+	check_eq("fields after duplicate", fields.size(), 5u);
+
+	thrown = false;
+	v8::TryCatch try_catch;
+	try
+	{
+		fields.get(context.run_script("({ get port() { throw new Error('no port'); } })").As<v8::Object>());
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("throwing getter", thrown);
+	check("getter exception pending", try_catch.HasCaught());
+}
@@ -0,0 +1,91 @@
+#include "v8pp/context.hpp"
+#include "v8pp/value.hpp"
+
+#include "test.hpp"
+
+void test_value()
+{
+	v8pp::context context;
+	v8::Isolate* isolate = context.isolate();
+
+	v8::HandleScope scope(isolate);
+
+	v8pp::value const v = v8pp::from_v8<v8pp::value>(isolate, context.run_script(
+		"({ name: 'test', size: 2.5, ok: true, none: null, undef: undefined, f: function() {},"
+		" list: [1, 'two', [3], { four: 4 }], nested: { a: { b: { c: 'deep' } } } })"));
+
+	check("object", v.is_object());
+	check_eq("members", v.size(), 8u);
+	check_eq("first key", v.key(0), "name");
+	check_eq("string", v["name"].as_string(), "test");
+	check_eq("number", v["size"].as_number(), 2.5);
+	check_eq("boolean", v["ok"].as_bool(), true);
+	check("null", v["none"].is_null());
+	check("undefined", v.contains("undef") && v["undef"].is_null());
+	check("function", v["f"].is_null());
+	check("missing", !v.contains("missing") && v["missing"].is_null());
+	check_eq("list size", v["list"].size(), 4u);
+	check_eq("list[1]", v["list"][1].as_string(), "two");
+	check_eq("list[2][0]", v["list"][2][0].as_number(), 3.0);
+	check_eq("list[3].four", v["list"][3]["four"].as_number(), 4.0);
+	check_eq("nested", v["nested"]["a"]["b"]["c"].as_string(), "deep");
+	check("arena", v.arena() && v.arena()->block_count() == 1);
+
+	bool thrown = false;
+	try
+	{
+		v["name"].as_number();
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("type mismatch", thrown);
+
+	context.set("v", v8pp::to_v8(isolate, v));
+	check_eq("to_v8", run_script<std::string>(context, "JSON.stringify(v.list) + v.nested.a.b.c"),
+		"[1,\"two\",[3],{\"four\":4}]deep");
+
+	v8pp::value_builder b;
+	v8pp::value const built = b.object({
+		{ "id", b.number(7) },
+		{ "tags", b.array({ b.string("x"), b.boolean(false), b.null() }) },
+		{ "copy", v["list"] },
+	});
+	context.set("built", v8pp::to_v8(isolate, built));
+	check_eq("builder", run_script<std::string>(context, "JSON.stringify(built)"),
+		"{\"id\":7,\"tags\":[\"x\",false,null],\"copy\":[1,\"two\",[3],{\"four\":4}]}");
+
+	v8pp::value const big = v8pp::from_v8<v8pp::value>(isolate, context.run_script(
+		"var a = []; for (var i = 0; i < 10000; ++i) a.push({ i: i, s: 'item' + i }); a"));
+	check_eq("big size", big.size(), 10000u);
+	check_eq("big item", big[9999]["s"].as_string(), "item9999");
+	check("few allocations", big.arena()->block_count() < 10);
+
+	thrown = false;
+	try
+	{
+		v8pp::from_v8<v8pp::value>(isolate, context.run_script("var c = {}; c.self = c; c"));
+	}
+	catch (std::invalid_argument const&)
+	{
+		thrown = true;
+	}
+	check("cyclic object", thrown);
+
+	thrown = false;
+	{
+		v8::TryCatch try_catch;
+		try
+		{
+			v8pp::from_v8<v8pp::value>(isolate, context.run_script(
+				"({ a: [1, { get b() { throw new Error('getter'); } }] })"));
+		}
+		catch (std::invalid_argument const&)
+		{
+			thrown = true;
+		}
+		check("throwing getter exception", try_catch.HasCaught());
+	}
+	check("throwing getter", thrown);
+}
@@ -0,0 +1,135 @@
+#include "v8pp/array_buffer.hpp"
+#include "v8pp/context.hpp"
+#include "v8pp/isolate_data.hpp"
+
+#include <stdexcept>
+#include <unordered_set>
+
+namespace v8pp {
+
+static v8::ArrayBuffer::Allocator& allocator()
+{
+	v8::ArrayBuffer::Allocator* allocator = context::array_buffer_allocator();
+	if (!allocator)
+	{
+		throw std::runtime_error("no ArrayBuffer allocator, see context_options::array_buffer_allocator");
+	}
+	return *allocator;
+}
+
+namespace detail {
+
+// Memory of ArrayBuffers adopted in an isolate and not released yet
+struct adopted_buffers
+{
+	explicit adopted_buffers(v8::Isolate*) {}
+
+	std::unordered_multiset<void*> data;
+
+	bool remove(void* ptr)
+	{
+		auto const it = data.find(ptr);
+		if (it == data.end())
+		{
+			return false;
+		}
+		data.erase(it);
+		return true;
+	}
+};
+
+} // namespace detail
+
+namespace {
+
+// Adopted ArrayBuffer backing store, freed on garbage collection
+struct adopted_contents
+{
+	array_buffer_contents contents;
+	v8::ArrayBuffer::Allocator* allocator;
+	v8::Persistent<v8::ArrayBuffer> handle;
+};
+
+} // unnamed namespace
+
+v8::Local<v8::ArrayBuffer> adopt_array_buffer(v8::Isolate* isolate, array_buffer_contents contents)
+{
+	v8::EscapableHandleScope scope(isolate);
+
+	adopted_contents* adopted = new adopted_contents;
+	adopted->contents = contents;
+	adopted->allocator = &allocator();
+
+	v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, contents.data, contents.length);
+	adopted->handle.Reset(isolate, buffer);
+	adopted->handle.SetWeak(adopted,
+		[](v8::WeakCallbackData<v8::ArrayBuffer, adopted_contents> const& data)
+		{
+			adopted_contents* adopted = data.GetParameter();
+			v8::Isolate* isolate = data.GetIsolate();
+			// a released buffer memory has a new owner
+			detail::adopted_buffers* owned = detail::isolate_data::find<detail::adopted_buffers>(isolate);
+			if (owned && owned->remove(adopted->contents.data))
+			{
+				adopted->allocator->Free(adopted->contents.data, adopted->contents.length);
+				isolate->AdjustAmountOfExternalAllocatedMemory(
+					-static_cast<int64_t>(adopted->contents.length));
+			}
+			adopted->handle.Reset();
+			delete adopted;
+		});
+	detail::isolate_data::get<detail::adopted_buffers>(isolate).data.insert(contents.data);
+	isolate->AdjustAmountOfExternalAllocatedMemory(static_cast<int64_t>(contents.length));
+
+	return scope.Escape(buffer);
+}
+
+static void* external_data(v8::Local<v8::ArrayBuffer> buffer)
+{
+	// external buffer has no contents accessor in V8 3.2x,
+	// its typed array view exposes the data
+	return v8::Uint8Array::New(buffer, 0, buffer->ByteLength())->GetIndexedPropertiesExternalArrayData();
+}
+
+bool can_release_array_buffer(v8::Local<v8::ArrayBuffer> buffer)
+{
+	if (!buffer->IsExternal())
+	{
+		return true;
+	}
+	detail::adopted_buffers* owned = detail::isolate_data::find<detail::adopted_buffers>(buffer->GetIsolate());
+	return owned && owned->data.count(external_data(buffer)) != 0;
+}
+
+array_buffer_contents release_array_buffer(v8::Local<v8::ArrayBuffer> buffer)
+{
+	// the released memory is to be freed with the allocator
+	allocator();
+
+	array_buffer_contents result;
+	result.length = buffer->ByteLength();
+	if (buffer->IsExternal())
+	{
+		// only adopted buffers own memory of the allocator, others are owned
+		// by their creators, such as vectors moved into ArrayBuffers or ndarray views
+		result.data = external_data(buffer);
+		detail::adopted_buffers* owned = detail::isolate_data::find<detail::adopted_buffers>(buffer->GetIsolate());
+		if (!owned || !owned->remove(result.data))
+		{
+			throw std::runtime_error("release_array_buffer: external ArrayBuffer is not adopted");
+		}
+	}
+	else
+	{
+		result.data = buffer->Externalize().Data();
+	}
+	buffer->Neuter();
+	return result;
+}
+
+void free_array_buffer(array_buffer_contents contents)
+{
+	allocator().Free(contents.data, contents.length);
+}
+
+} // namespace v8pp
@@ -0,0 +1,40 @@
+#ifndef V8PP_ARRAY_BUFFER_HPP_INCLUDED
+#define V8PP_ARRAY_BUFFER_HPP_INCLUDED
+
+#include <cstddef>
+
+#include <v8.h>
+
+namespace v8pp {
+
+/// ArrayBuffer backing store owned by the embedder
+struct array_buffer_contents
+{
+	void* data;
+	size_t length;
+};
+
+/// Create an ArrayBuffer owning memory allocated with the ArrayBuffer allocator
+/// set by context_options::array_buffer_allocator. The memory is freed with
+/// the allocator when the ArrayBuffer is garbage collected, unless it was
+/// released with release_array_buffer() before.
+/// Throws std::runtime_error if no allocator is set.
+v8::Local<v8::ArrayBuffer> adopt_array_buffer(v8::Isolate* isolate, array_buffer_contents contents);
+
+/// Move the ArrayBuffer backing store out, the ArrayBuffer is neutered.
+/// The returned memory should be freed with the ArrayBuffer allocator
+/// or passed to adopt_array_buffer(), possibly in another isolate.
+/// Throws std::runtime_error if no allocator is set, or for an external
+/// ArrayBuffer not created with adopt_array_buffer(), its memory is not
+/// owned by the allocator.
+array_buffer_contents release_array_buffer(v8::Local<v8::ArrayBuffer> buffer);
+
+/// Check that release_array_buffer() can move the ArrayBuffer backing store out
+bool can_release_array_buffer(v8::Local<v8::ArrayBuffer> buffer);
+
+/// Free memory released from an ArrayBuffer with the ArrayBuffer allocator
+void free_array_buffer(array_buffer_contents contents);
+
+} // namespace v8pp
+
+#endif // V8PP_ARRAY_BUFFER_HPP_INCLUDED
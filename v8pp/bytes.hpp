@@ -0,0 +1,189 @@
+#ifndef V8PP_BYTES_HPP_INCLUDED
+#define V8PP_BYTES_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+
+namespace v8pp {
+
+/// Binary data converted to V8 ArrayBuffer. A moved bytes value,
+/// such as a function result, gives its storage to the ArrayBuffer
+/// without copying, it is freed when the ArrayBuffer is garbage collected.
+/// Such ArrayBuffer should not be transferred with serialize()
+struct bytes : std::vector<uint8_t>
+{
+	using base_type = std::vector<uint8_t>;
+
+	bytes() {}
+	bytes(base_type&& data) : base_type(std::move(data)) {}
+	bytes(base_type const& data) : base_type(data) {}
+	bytes(void const* data, size_t size)
+		: base_type(static_cast<uint8_t const*>(data), static_cast<uint8_t const*>(data) + size)
+	{
+	}
+};
+
+/// Non-owning view of binary data in V8 ArrayBuffer, typed array or DataView,
+/// valid while the V8 value is alive and not neutered
+struct bytes_view
+{
+	uint8_t* data;
+	size_t size;
+
+	bytes_view() : data(nullptr), size(0) {}
+	bytes_view(uint8_t* data, size_t size) : data(data), size(size) {}
+
+	uint8_t* begin() const { return data; }
+	uint8_t* end() const { return data + size; }
+};
+
+namespace detail {
+
+// ArrayBuffer contents are accessible via a typed array view in V8 3.2x
+inline uint8_t* array_buffer_data(v8::Handle<v8::ArrayBuffer> buffer)
+{
+	size_t const length = buffer->ByteLength();
+	if (length == 0)
+	{
+		return nullptr;
+	}
+	return static_cast<uint8_t*>(v8::Uint8Array::New(buffer, 0, length)
+		->GetIndexedPropertiesExternalArrayData());
+}
+
+// vector storage owned by an ArrayBuffer
+template<typename T>
+struct vector_holder
+{
+	std::vector<T> data;
+	v8::Persistent<v8::ArrayBuffer> handle;
+
+	size_t byte_length() const { return data.size() * sizeof(T); }
+};
+
+inline v8::Local<v8::ArrayBuffer> new_array_buffer(v8::Isolate* isolate, void const* data, size_t size)
+{
+	v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, size);
+	if (size)
+	{
+		std::memcpy(array_buffer_data(buffer), data, size);
+	}
+	return buffer;
+}
+
+// Move vector storage into a new ArrayBuffer, freed when it is garbage collected
+template<typename T>
+v8::Local<v8::ArrayBuffer> vector_array_buffer(v8::Isolate* isolate, std::vector<T>&& data)
+{
+	if (data.empty())
+	{
+		return v8::ArrayBuffer::New(isolate, 0);
+	}
+
+	vector_holder<T>* holder = new vector_holder<T>;
+	holder->data = std::move(data);
+	size_t const size = holder->byte_length();
+
+	v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, holder->data.data(), size);
+	holder->handle.Reset(isolate, buffer);
+	holder->handle.SetWeak(holder,
+		[](v8::WeakCallbackData<v8::ArrayBuffer, vector_holder<T>> const& data)
+		{
+			vector_holder<T>* holder = data.GetParameter();
+			data.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(
+				-static_cast<int64_t>(holder->byte_length()));
+			holder->handle.Reset();
+			delete holder;
+		});
+	isolate->AdjustAmountOfExternalAllocatedMemory(static_cast<int64_t>(size));
+	return buffer;
+}
+
+} // namespace detail
+
+template<>
+struct convert<bytes_view>
+{
+	using from_type = bytes_view;
+	using to_type = v8::Handle<v8::ArrayBuffer>;
+
+	static bool is_valid(v8::Isolate*, v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && (value->IsArrayBuffer() || value->IsArrayBufferView());
+	}
+
+	static from_type from_v8(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+	{
+		if (!is_valid(isolate, value))
+		{
+			throw std::invalid_argument("expected ArrayBuffer or ArrayBufferView");
+		}
+		if (value->IsArrayBuffer())
+		{
+			v8::Handle<v8::ArrayBuffer> buffer = value.As<v8::ArrayBuffer>();
+			return bytes_view(detail::array_buffer_data(buffer), buffer->ByteLength());
+		}
+		v8::Handle<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+		uint8_t* data = detail::array_buffer_data(view->Buffer());
+		return bytes_view(data? data + view->ByteOffset() : nullptr, view->ByteLength());
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, bytes_view value)
+	{
+		v8::EscapableHandleScope scope(isolate);
+		return scope.Escape(detail::new_array_buffer(isolate, value.data, value.size));
+	}
+};
+
+template<>
+struct convert<bytes>
+{
+	using from_type = bytes;
+	using to_type = v8::Handle<v8::ArrayBuffer>;
+
+	static bool is_valid(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+	{
+		return convert<bytes_view>::is_valid(isolate, value);
+	}
+
+	static from_type from_v8(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+	{
+		bytes_view const view = convert<bytes_view>::from_v8(isolate, value);
+		return bytes(view.data, view.size);
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, bytes const& value)
+	{
+		v8::EscapableHandleScope scope(isolate);
+		return scope.Escape(detail::new_array_buffer(isolate, value.data(), value.size()));
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, bytes&& value)
+	{
+		v8::EscapableHandleScope scope(isolate);
+		return scope.Escape(detail::vector_array_buffer<uint8_t>(isolate, std::move(value)));
+	}
+};
+
+template<>
+struct is_wrapped_class<bytes> : std::false_type {};
+
+template<>
+struct is_wrapped_class<bytes_view> : std::false_type {};
+
+/// Move bytes storage into a new ArrayBuffer without copying
+inline v8::Handle<v8::ArrayBuffer> to_v8(v8::Isolate* isolate, bytes&& value)
+{
+	return convert<bytes>::to_v8(isolate, std::move(value));
+}
+
+} // namespace v8pp
+
+#endif // V8PP_BYTES_HPP_INCLUDED
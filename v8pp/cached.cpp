@@ -0,0 +1,106 @@
+#include "v8pp/cached.hpp"
+#include "v8pp/isolate_data.hpp"
+
+#include <algorithm>
+
+namespace v8pp { namespace detail {
+
+static std::mutex& registry_mutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+static std::vector<cached_values*>& registry()
+{
+	static std::vector<cached_values*> caches;
+	return caches;
+}
+
+cached_values::cached_values(v8::Isolate* isolate)
+	: isolate_(isolate)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	registry().push_back(this);
+}
+
+cached_values::~cached_values()
+{
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	std::vector<cached_values*>& caches = registry();
+	caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+}
+
+cached_values& cached_values::instance(v8::Isolate* isolate)
+{
+	return isolate_data::get<cached_values>(isolate);
+}
+
+uint64_t cached_values::next_id()
+{
+	static std::atomic<uint64_t> next(0);
+	return next++;
+}
+
+void cached_values::retire(uint64_t id)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	for (cached_values* cache : registry())
+	{
+		if (cache->ids_.erase(id))
+		{
+			cache->retired_.push_back(id);
+		}
+	}
+}
+
+void cached_values::purge()
+{
+	std::vector<uint64_t> retired;
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		retired.swap(retired_);
+	}
+	for (uint64_t id : retired)
+	{
+		values_.erase(id);
+	}
+}
+
+v8::Local<v8::Value> cached_values::find(uint64_t id, uint64_t version)
+{
+	auto const it = values_.find(id);
+	if (it == values_.end() || it->second.version != version)
+	{
+		return v8::Local<v8::Value>();
+	}
+	return v8::Local<v8::Value>::New(isolate_, it->second.value);
+}
+
+void cached_values::store(uint64_t id, uint64_t version, v8::Handle<v8::Value> value)
+{
+	purge();
+
+	entry& e = values_[id];
+	e.version = version;
+	e.value.Reset(isolate_, value);
+
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	ids_.insert(id);
+}
+
+void cached_values::freeze(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+{
+	if (!value->IsObject())
+	{
+		return;
+	}
+	v8::HandleScope scope(isolate);
+	v8::Local<v8::Object> object_ctor = isolate->GetCurrentContext()->Global()
+		->Get(v8::String::NewFromUtf8(isolate, "Object")).As<v8::Object>();
+	v8::Local<v8::Function> freeze = object_ctor
+		->Get(v8::String::NewFromUtf8(isolate, "freeze")).As<v8::Function>();
+	freeze->Call(object_ctor, 1, &value);
+}
+
+}} // namespace v8pp::detail
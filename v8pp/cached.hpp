@@ -0,0 +1,171 @@
+#ifndef V8PP_CACHED_HPP_INCLUDED
+#define V8PP_CACHED_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+#include "v8pp/persistent.hpp"
+
+namespace v8pp {
+
+namespace detail {
+
+/// Per-isolate cache of V8 values converted from cached<T> objects
+class cached_values
+{
+public:
+	explicit cached_values(v8::Isolate* isolate);
+	~cached_values();
+
+	cached_values(cached_values const&) = delete;
+	cached_values& operator=(cached_values const&) = delete;
+
+	/// Cached values of the isolate, created on first use
+	static cached_values& instance(v8::Isolate* isolate);
+
+	/// Find a value converted for the object id and version, may return empty handle
+	v8::Local<v8::Value> find(uint64_t id, uint64_t version);
+
+	/// Store a value converted for the object id and version
+	void store(uint64_t id, uint64_t version, v8::Handle<v8::Value> value);
+
+	/// Number of cached values
+	size_t size() const { return values_.size(); }
+
+	/// Unique id for a cached object
+	static uint64_t next_id();
+
+	/// Drop values of a destroyed object in all isolates, may be called in any thread
+	static void retire(uint64_t id);
+
+	/// Freeze a V8 object with Object.freeze()
+	static void freeze(v8::Isolate* isolate, v8::Handle<v8::Value> value);
+
+private:
+	struct entry
+	{
+		uint64_t version;
+		persistent<v8::Value> value;
+	};
+
+	// drop values of retired objects, in the isolate thread
+	void purge();
+
+	v8::Isolate* isolate_;
+	std::unordered_map<uint64_t, entry> values_;
+
+	// guarded by the registry mutex
+	std::unordered_set<uint64_t> ids_;
+	std::vector<uint64_t> retired_;
+};
+
+} // namespace detail
+
+/// C++ value with identity and version, converted to V8 once per version
+/// in each isolate. The last converted V8 value is cached per isolate and
+/// returned by to_v8() while the version is unchanged. A value may be frozen
+/// with Object.freeze() after conversion, to prevent its modification in JavaScript.
+///
+/// The value should not be modified during conversion in other threads.
+template<typename T>
+class cached
+{
+public:
+	explicit cached(T value = T(), bool freeze = false)
+		: value_(std::move(value))
+		, id_(detail::cached_values::next_id())
+		, version_(0)
+		, freeze_(freeze)
+	{
+	}
+
+	~cached()
+	{
+		detail::cached_values::retire(id_);
+	}
+
+	cached(cached const&) = delete;
+	cached& operator=(cached const&) = delete;
+
+	/// Get the value
+	T const& get() const { return value_; }
+
+	/// Replace the value, increment the version
+	void set(T value)
+	{
+		value_ = std::move(value);
+		touch();
+	}
+
+	/// Modify the value in place with `func(T&)`, increment the version
+	template<typename Func>
+	void update(Func func)
+	{
+		func(value_);
+		touch();
+	}
+
+	/// Increment the version, to convert the value again
+	void touch() { ++version_; }
+
+	/// Object identity, unique in the process
+	uint64_t id() const { return id_; }
+
+	/// Value version
+	uint64_t version() const { return version_; }
+
+	/// Are converted values frozen
+	bool frozen() const { return freeze_; }
+
+private:
+	T value_;
+	uint64_t const id_;
+	std::atomic<uint64_t> version_;
+	bool const freeze_;
+};
+
+template<typename T>
+struct convert<cached<T>>
+{
+	using from_type = cached<T>;
+	using to_type = v8::Handle<v8::Value>;
+
+	static bool is_valid(v8::Isolate*, v8::Handle<v8::Value>)
+	{
+		return false;
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, cached<T> const& value)
+	{
+		v8::EscapableHandleScope scope(isolate);
+
+		detail::cached_values& values = detail::cached_values::instance(isolate);
+		uint64_t const version = value.version();
+		v8::Local<v8::Value> result = values.find(value.id(), version);
+		if (result.IsEmpty())
+		{
+			result = convert<T>::to_v8(isolate, value.get());
+			if (value.frozen())
+			{
+				detail::cached_values::freeze(isolate, result);
+			}
+			values.store(value.id(), version, result);
+		}
+		return scope.Escape(result);
+	}
+};
+
+template<typename T>
+struct is_wrapped_class<cached<T>> : std::false_type {};
+
+} // namespace v8pp
+
+#endif // V8PP_CACHED_HPP_INCLUDED
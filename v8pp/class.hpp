@@ -2,12 +2,14 @@
 #define V8PP_CLASS_HPP_INCLUDED
 
 #include <algorithm>
+#include <atomic>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include "v8pp/config.hpp"
 #include "v8pp/factory.hpp"
+#include "v8pp/finalizer.hpp"
 #include "v8pp/function.hpp"
 #include "v8pp/persistent.hpp"
 #include "v8pp/property.hpp"
@@ -32,6 +34,11 @@ public:
 	class_info(class_info const&) = delete;
 	class_info& operator=(class_info const&) = delete;
 
+	/// Dispose a wrapped C++ object of the class: destroy it if it's owned
+	/// by JavaScript, clear the object internal field and remove it from
+	/// the class objects. Return false for already disposed object
+	virtual bool dispose(v8::Handle<v8::Object> obj) = 0;
+
 	using cast_function = void* (*)(void* ptr);
 
 	void add_base(class_info* info, cast_function cast)
@@ -85,6 +92,21 @@ public:
 		objects_.emplace(object, persistent<v8::Object>(isolate, handle));
 	}
 
+	template<typename T>
+	void set_weak(T* object, typename v8::WeakCallbackData<v8::Object, T>::Callback callback)
+	{
+		auto it = objects_.find(object);
+		assert(it != objects_.end() && "no object");
+		it->second.SetWeak(object, callback);
+	}
+
+	// objects owned by JavaScript have weak handles
+	bool is_weak(void* object) const
+	{
+		auto it = objects_.find(object);
+		return it != objects_.end() && it->second.IsWeak();
+	}
+
 	template<typename T>
 	void remove_object(v8::Isolate* isolate, T* object, void (*destroy)(v8::Isolate* isolate, T* obj))
 	{
@@ -135,7 +157,8 @@ public:
 protected:
 	static type_index register_class()
 	{
-		static type_index next_index = 0;
+		// classes may be registered in several threads with own isolates
+		static std::atomic<type_index> next_index(0);
 		return next_index++;
 	}
 
@@ -172,24 +195,11 @@ private:
 		: class_info(type)
 		, isolate_(isolate)
 		, ctor_(nullptr)
+		, finalization_(finalization_policy::immediate)
+		, bound_(false)
 	{
 		v8::Local<v8::FunctionTemplate> func = v8::FunctionTemplate::New(isolate_);
-		v8::Local<v8::FunctionTemplate> js_func = v8::FunctionTemplate::New(isolate_,
-			[](v8::FunctionCallbackInfo<v8::Value> const& args)
-			{
-				v8::Isolate* isolate = args.GetIsolate();
-				try
-				{
-					return args.GetReturnValue().Set(instance(isolate).wrap_object(args));
-				}
-				catch (std::exception const& ex)
-				{
-					args.GetReturnValue().Set(throw_ex(isolate, ex.what()));
-				}
-			});
-
 		func_.Reset(isolate_, func);
-		js_func_.Reset(isolate_, js_func);
 
 		// each JavaScript instance has 2 internal fields:
 		//  0 - pointer to a wrapped C++ object
@@ -212,24 +222,29 @@ public:
 			isolate->SetData(V8PP_ISOLATE_DATA_SLOT, singletons);
 		}
 
-		// Get singleton instance from the the list by class_type
+		// Get singleton instance from the the list by class_type,
+		// classes may be bound in isolates in different order
 		type_index const my_type = class_type();
-		class_singleton* result;
-		if (my_type < singletons->size())
+		if (my_type >= singletons->size())
 		{
-			result = static_cast<class_singleton*>((*singletons)[my_type]);
+			singletons->resize(my_type + 1);
 		}
-		else
+		class_singleton* result = static_cast<class_singleton*>((*singletons)[my_type]);
+		if (!result)
 		{
 			// No singleton instance, create and add it
 			result = new class_singleton(isolate, my_type);
-			singletons->emplace_back(result);
+			(*singletons)[my_type] = result;
 		}
 		return *result;
 	}
 
 	v8::Isolate* isolate() { return isolate_; }
 
+	/// Was the class bound with v8pp::class_ in the isolate
+	bool is_bound() const { return bound_; }
+	void set_bound() { bound_ = true; }
+
 	v8::Local<v8::FunctionTemplate> class_function_template()
 	{
 		return to_local(isolate_, func_);
@@ -237,7 +252,26 @@ public:
 
 	v8::Local<v8::FunctionTemplate> js_function_template()
 	{
-		return to_local(isolate_, js_func_.IsEmpty()? func_ : js_func_);
+		// create JavaScript constructor template on first use,
+		// classes not visible in JavaScript don't need it
+		if (js_func_.IsEmpty())
+		{
+			v8::Local<v8::FunctionTemplate> js_func = v8::FunctionTemplate::New(isolate_,
+				[](v8::FunctionCallbackInfo<v8::Value> const& args)
+				{
+					v8::Isolate* isolate = args.GetIsolate();
+					try
+					{
+						return args.GetReturnValue().Set(instance(isolate).wrap_object(args));
+					}
+					catch (std::exception const& ex)
+					{
+						args.GetReturnValue().Set(throw_ex(isolate, ex.what()));
+					}
+				});
+			js_func_.Reset(isolate_, js_func);
+		}
+		return to_local(isolate_, js_func_);
 	}
 
 	template<typename ...Args>
@@ -275,17 +309,52 @@ public:
 		return scope.Escape(obj);
 	}
 
+	bool dispose(v8::Handle<v8::Object> obj) override
+	{
+		T* ptr = static_cast<T*>(obj->GetAlignedPointerFromInternalField(0));
+		if (!ptr)
+		{
+			return false;
+		}
+		obj->SetAlignedPointerInInternalField(0, nullptr);
+		if (class_info::is_weak(ptr))
+		{
+			destroy_object(ptr);
+		}
+		else
+		{
+			class_info::remove_object<T>(isolate_, ptr, nullptr);
+		}
+		return true;
+	}
+
 	v8::Handle<v8::Object> wrap_object(T* wrap)
 	{
 		v8::EscapableHandleScope scope(isolate_);
 
 		v8::Local<v8::Object> obj = wrap_external_object(wrap);
 
-		v8::Persistent<v8::Object> pobj(isolate_, obj);
-		pobj.SetWeak(wrap,
+		// the object handle is reset on destroy or dispose
+		class_info::set_weak(wrap,
 			[](v8::WeakCallbackData<v8::Object, T> const& data)
 			{
-				instance(data.GetIsolate()).destroy_object(data.GetParameter());
+				v8::Isolate* isolate = data.GetIsolate();
+				class_singleton& self = instance(isolate);
+				T* object = data.GetParameter();
+				if (self.finalization_ == finalization_policy::deferred)
+				{
+					// unlink now, destroy outside of the GC pause
+					self.class_info::remove_object<T>(isolate, object, nullptr);
+					isolate_data::get<finalizer_queue>(isolate).push(object,
+						[](v8::Isolate* isolate, void* object)
+						{
+							factory<T>::destroy(isolate, static_cast<T*>(object));
+						});
+				}
+				else
+				{
+					self.destroy_object(object);
+				}
 			});
 
 		return scope.Escape(obj);
@@ -332,9 +401,16 @@ public:
 		class_info::remove_object(isolate_, obj, &factory<T>::destroy);
 	}
 
+	void set_finalization(finalization_policy policy)
+	{
+		finalization_ = policy;
+	}
+
 private:
 	v8::Isolate* isolate_;
 	std::function<T* (v8::FunctionCallbackInfo<v8::Value> const& args)> ctor_;
+	finalization_policy finalization_;
+	bool bound_;
 
 	v8::UniquePersistent<v8::FunctionTemplate> func_;
 	v8::UniquePersistent<v8::FunctionTemplate> js_func_;
@@ -351,6 +427,14 @@ public:
 	explicit class_(v8::Isolate* isolate)
 		: class_singleton_(class_singleton::instance(isolate))
 	{
+		class_singleton_.set_bound();
+	}
+
+	/// Was the class already bound with a class_ instance in the isolate,
+	/// use it to register class members once per isolate
+	static bool is_bound(v8::Isolate* isolate)
+	{
+		return class_singleton::instance(isolate).is_bound();
 	}
 
 	/// Set class constructor signature
@@ -489,6 +573,48 @@ public:
 		return class_singleton::instance(isolate).find_object(obj);
 	}
 
+	/// Set destruction policy for garbage collected objects of the class,
+	/// finalization_policy::deferred moves expensive destructors out of GC pauses
+	class_& set_finalization(finalization_policy policy)
+	{
+		class_singleton_.set_finalization(policy);
+		return *this;
+	}
+
+	/// Set a method to dispose wrapped C++ object from JavaScript before
+	/// garbage collection. Objects created in JavaScript or imported with
+	/// import_external() are destroyed, external references are detached.
+	/// Calls of the object methods throw after dispose.
+	class_& set_dispose(char const* name = "dispose")
+	{
+		v8::HandleScope scope(isolate());
+
+		class_singleton_.class_function_template()->PrototypeTemplate()->Set(isolate(), name,
+			v8::FunctionTemplate::New(isolate(), [](v8::FunctionCallbackInfo<v8::Value> const& args)
+			{
+				args.GetReturnValue().Set(dispose_object(args.GetIsolate(), args.This()));
+			}));
+		return *this;
+	}
+
+	/// Dispose wrapped C++ object, see set_dispose().
+	/// Return false if the value is not a wrapped object or is already disposed
+	static bool dispose_object(v8::Isolate*, v8::Handle<v8::Value> value)
+	{
+		if (value.IsEmpty() || !value->IsObject())
+		{
+			return false;
+		}
+		v8::Handle<v8::Object> obj = value.As<v8::Object>();
+		if (obj->InternalFieldCount() != 2)
+		{
+			return false;
+		}
+		// the object may be of a derived class
+		detail::class_info* info = static_cast<detail::class_info*>(obj->GetAlignedPointerFromInternalField(1));
+		return info && info->dispose(obj);
+	}
+
 	/// Destroy wrapped C++ object
 	static void destroy_object(v8::Isolate* isolate, T* obj)
 	{
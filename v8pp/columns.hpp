@@ -0,0 +1,368 @@
+#ifndef V8PP_COLUMNS_HPP_INCLUDED
+#define V8PP_COLUMNS_HPP_INCLUDED
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/bytes.hpp"
+#include "v8pp/convert.hpp"
+#include "v8pp/persistent.hpp"
+#include "v8pp/typed_array.hpp"
+
+namespace v8pp {
+
+namespace detail {
+
+// Typed array element type for a column of T values:
+// bool as uint8_t, 64-bit integers as double
+template<typename T, typename Enable = void>
+struct column_element
+{
+	using type = T;
+};
+
+template<>
+struct column_element<bool>
+{
+	using type = uint8_t;
+};
+
+template<typename T>
+struct column_element<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 8>::type>
+{
+	using type = double;
+};
+
+// Is a column element value representable in field type T:
+// 64-bit integers are stored as doubles, NaN and out of range values
+// are undefined behavior in a cast
+template<typename T, typename E>
+typename std::enable_if<std::is_integral<T>::value && std::is_floating_point<E>::value, bool>::type
+column_value_in_range(E value)
+{
+	// 2^digits is exact in floating point, unlike the max value
+	E const limit = std::ldexp(E(1), std::numeric_limits<T>::digits);
+	return std::is_signed<T>::value? value >= -limit && value < limit : value > E(-1) && value < limit;
+}
+
+template<typename T, typename E>
+typename std::enable_if<!(std::is_integral<T>::value && std::is_floating_point<E>::value), bool>::type
+column_value_in_range(E)
+{
+	return true;
+}
+
+} // namespace detail
+
+/// Description of C++ record struct S fields to convert a vector of records
+/// into a V8 object of columns, one per field, instead of an object per row:
+///
+///     struct trade { std::string symbol; double price; int64_t volume; };
+///
+///     v8pp::columns<trade> trade_columns(isolate);
+///     trade_columns
+///         .field("symbol", &trade::symbol)
+///         .field("price", &trade::price)
+///         .field("volume", &trade::volume);
+///
+///     v8::Local<v8::Object> table = trade_columns.to_v8(trades);
+///
+/// The result has a `length` property with the number of rows, a typed array
+/// for each arithmetic field (bool as Uint8Array, 64-bit integers as Float64Array),
+/// and a `{ strings, index }` table for each std::string field, where `strings`
+/// is an Array of unique values and `index` is an Uint32Array of indices to them.
+/// from_v8() accepts the same object, or a string column as an Array of strings.
+template<typename S>
+class columns
+{
+public:
+	explicit columns(v8::Isolate* isolate)
+		: isolate_(isolate)
+	{
+	}
+
+	columns(columns const&) = delete;
+	columns& operator=(columns const&) = delete;
+
+	/// V8 isolate of the column names
+	v8::Isolate* isolate() { return isolate_; }
+
+	/// Number of columns
+	size_t size() const { return fields_.size(); }
+
+	/// Add a column for arithmetic, enum or std::string field of S
+	template<typename T>
+	columns& field(char const* name, T S::*member)
+	{
+		v8::HandleScope scope(isolate_);
+
+		v8::Local<v8::String> key = v8::String::NewFromUtf8(isolate_, name, v8::String::kInternalizedString);
+		if (key->StrictEquals(length_name(isolate_)))
+		{
+			throw std::invalid_argument("reserved column name length");
+		}
+		for (field_info const& f : fields_)
+		{
+			if (key->StrictEquals(v8::Local<v8::String>::New(isolate_, f.name)))
+			{
+				throw std::invalid_argument(std::string("duplicate column ") + name);
+			}
+		}
+
+		field_info f;
+		f.name.Reset(isolate_, key);
+		set_converters(f, member, std::is_same<T, std::string>());
+		fields_.emplace_back(std::move(f));
+		return *this;
+	}
+
+	/// Convert rows to a V8 object of columns
+	v8::Local<v8::Object> to_v8(std::vector<S> const& rows) const
+	{
+		v8::EscapableHandleScope scope(isolate_);
+
+		v8::Local<v8::Object> result = v8::Object::New(isolate_);
+		result->Set(length_name(isolate_), v8::Number::New(isolate_, static_cast<double>(rows.size())));
+		for (field_info const& f : fields_)
+		{
+			result->Set(v8::Local<v8::String>::New(isolate_, f.name), f.to_v8(isolate_, rows));
+		}
+		return scope.Escape(result);
+	}
+
+	/// Fill rows from a V8 object of columns, replacing existing rows.
+	/// Throws std::invalid_argument on a missing or invalid column, or a 64-bit
+	/// integer value out of range, the rows are not changed then
+	void from_v8(v8::Handle<v8::Object> obj, std::vector<S>& rows) const
+	{
+		v8::HandleScope scope(isolate_);
+
+		v8::Local<v8::Value> length = obj->Get(length_name(isolate_));
+		if (length.IsEmpty() || !length->IsUint32())
+		{
+			throw std::invalid_argument("expected columns length");
+		}
+		uint32_t const count = length->Uint32Value();
+
+		// validate all columns before changing rows
+		std::vector<row_filler> fillers;
+		fillers.reserve(fields_.size());
+		for (field_info const& f : fields_)
+		{
+			v8::Local<v8::String> name = v8::Local<v8::String>::New(isolate_, f.name);
+			v8::Local<v8::Value> column = obj->Get(name);
+			if (column.IsEmpty() || column->IsUndefined())
+			{
+				throw std::invalid_argument("missing column " + convert<std::string>::from_v8(isolate_, name));
+			}
+			fillers.emplace_back(f.from_v8(isolate_, column, count));
+		}
+
+		rows.assign(count, S());
+		for (row_filler const& fill : fillers)
+		{
+			fill(rows);
+		}
+	}
+
+	/// Create rows from a V8 object of columns, see from_v8(obj, rows)
+	std::vector<S> from_v8(v8::Handle<v8::Object> obj) const
+	{
+		std::vector<S> rows;
+		from_v8(obj, rows);
+		return rows;
+	}
+
+private:
+	// fills a field in validated rows
+	using row_filler = std::function<void(std::vector<S>&)>;
+
+	struct field_info
+	{
+		persistent<v8::String> name;
+		std::function<v8::Local<v8::Value>(v8::Isolate*, std::vector<S> const&)> to_v8;
+		// validates a column of length rows, throws std::invalid_argument
+		std::function<row_filler(v8::Isolate*, v8::Local<v8::Value>, size_t)> from_v8;
+	};
+
+	static v8::Local<v8::String> length_name(v8::Isolate* isolate)
+	{
+		return v8::String::NewFromUtf8(isolate, "length", v8::String::kInternalizedString);
+	}
+
+	// arithmetic column, filled directly in the ArrayBuffer storage
+	template<typename T>
+	static void set_converters(field_info& f, T S::*member, std::false_type)
+	{
+		using element_type = typename detail::column_element<T>::type;
+		using array_traits = typed_array<element_type>;
+
+		f.to_v8 = [member](v8::Isolate* isolate, std::vector<S> const& rows) -> v8::Local<v8::Value>
+			{
+				std::vector<element_type> data(rows.size());
+				for (size_t i = 0; i < rows.size(); ++i)
+				{
+					data[i] = static_cast<element_type>(rows[i].*member);
+				}
+				v8::Local<v8::ArrayBuffer> buffer = detail::vector_array_buffer(isolate, std::move(data));
+				return array_traits::create(buffer, 0, rows.size());
+			};
+
+		f.from_v8 = [member](v8::Isolate*, v8::Local<v8::Value> column, size_t length) -> row_filler
+			{
+				if (!array_traits::is_valid(column))
+				{
+					throw std::invalid_argument("expected typed array column");
+				}
+				v8::Local<v8::TypedArray> array = column.As<v8::TypedArray>();
+				if (array->Length() < length)
+				{
+					throw std::invalid_argument("column is shorter than length");
+				}
+				if (length == 0)
+				{
+					return [](std::vector<S>&) {};
+				}
+				// copy validated values, getters of other columns may change the array
+				uint8_t* bytes = detail::array_buffer_data(array->Buffer());
+				element_type const* data = reinterpret_cast<element_type const*>(bytes + array->ByteOffset());
+				std::shared_ptr<std::vector<T>> values = std::make_shared<std::vector<T>>(length);
+				for (size_t i = 0; i < length; ++i)
+				{
+					element_type const value = data[i];
+					if (!detail::column_value_in_range<T>(value))
+					{
+						throw std::invalid_argument("column value out of range");
+					}
+					(*values)[i] = static_cast<T>(value);
+				}
+				return [member, values](std::vector<S>& rows)
+					{
+						for (size_t i = 0; i < rows.size(); ++i)
+						{
+							rows[i].*member = (*values)[i];
+						}
+					};
+			};
+	}
+
+	// string column as a table of unique strings and their indices
+	static void set_converters(field_info& f, std::string S::*member, std::true_type)
+	{
+		f.to_v8 = [member](v8::Isolate* isolate, std::vector<S> const& rows) -> v8::Local<v8::Value>
+			{
+				std::unordered_map<std::string, uint32_t> unique;
+				v8::Local<v8::Array> strings = v8::Array::New(isolate);
+				std::vector<uint32_t> index(rows.size());
+				for (size_t i = 0; i < rows.size(); ++i)
+				{
+					std::string const& str = rows[i].*member;
+					auto const it = unique.emplace(str, static_cast<uint32_t>(unique.size())).first;
+					if (it->second == strings->Length())
+					{
+						strings->Set(it->second, convert<std::string>::to_v8(isolate, str));
+					}
+					index[i] = it->second;
+				}
+
+				v8::Local<v8::ArrayBuffer> buffer = detail::vector_array_buffer(isolate, std::move(index));
+				v8::Local<v8::Object> table = v8::Object::New(isolate);
+				table->Set(v8::String::NewFromUtf8(isolate, "strings"), strings);
+				table->Set(v8::String::NewFromUtf8(isolate, "index"),
+					typed_array<uint32_t>::create(buffer, 0, rows.size()));
+				return table;
+			};
+
+		f.from_v8 = [member](v8::Isolate* isolate, v8::Local<v8::Value> column, size_t length) -> row_filler
+			{
+				if (column->IsArray())
+				{
+					v8::Local<v8::Array> values = column.As<v8::Array>();
+					if (values->Length() < length)
+					{
+						throw std::invalid_argument("column is shorter than length");
+					}
+					std::shared_ptr<std::vector<std::string>> strings = std::make_shared<std::vector<std::string>>(length);
+					for (uint32_t i = 0; i < length; ++i)
+					{
+						(*strings)[i] = convert<std::string>::from_v8(isolate, values->Get(i));
+					}
+					return [member, strings](std::vector<S>& rows)
+						{
+							for (size_t i = 0; i < rows.size(); ++i)
+							{
+								rows[i].*member = std::move((*strings)[i]);
+							}
+						};
+				}
+
+				v8::Local<v8::Value> strings_value, index_value;
+				if (column->IsObject())
+				{
+					v8::Local<v8::Object> table = column.As<v8::Object>();
+					strings_value = table->Get(v8::String::NewFromUtf8(isolate, "strings"));
+					index_value = table->Get(v8::String::NewFromUtf8(isolate, "index"));
+				}
+				if (strings_value.IsEmpty() || !strings_value->IsArray()
+					|| !typed_array<uint32_t>::is_valid(index_value))
+				{
+					throw std::invalid_argument("expected string table column");
+				}
+
+				v8::Local<v8::Array> strings_array = strings_value.As<v8::Array>();
+				std::shared_ptr<std::vector<std::string>> strings = std::make_shared<std::vector<std::string>>(strings_array->Length());
+				for (uint32_t i = 0; i < strings->size(); ++i)
+				{
+					(*strings)[i] = convert<std::string>::from_v8(isolate, strings_array->Get(i));
+				}
+
+				v8::Local<v8::TypedArray> index_array = index_value.As<v8::TypedArray>();
+				if (index_array->Length() < length)
+				{
+					throw std::invalid_argument("column is shorter than length");
+				}
+				if (length == 0)
+				{
+					return [](std::vector<S>&) {};
+				}
+
+				// copy validated indices, getters of other columns may change the array
+				uint8_t* bytes = detail::array_buffer_data(index_array->Buffer());
+				uint32_t const* data = reinterpret_cast<uint32_t const*>(bytes + index_array->ByteOffset());
+				std::shared_ptr<std::vector<uint32_t>> index = std::make_shared<std::vector<uint32_t>>(length);
+				for (size_t i = 0; i < length; ++i)
+				{
+					uint32_t const value = data[i];
+					if (value >= strings->size())
+					{
+						throw std::invalid_argument("string index out of range");
+					}
+					(*index)[i] = value;
+				}
+				return [member, strings, index](std::vector<S>& rows)
+					{
+						for (size_t i = 0; i < rows.size(); ++i)
+						{
+							rows[i].*member = (*strings)[(*index)[i]];
+						}
+					};
+			};
+	}
+
+	v8::Isolate* isolate_;
+	std::vector<field_info> fields_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_COLUMNS_HPP_INCLUDED
@@ -6,6 +6,16 @@
 #define V8PP_ISOLATE_DATA_SLOT 0
 #endif
 
+/// v8::Isolate data slot number, used to store per-isolate v8pp services
+#if !defined(V8PP_ISOLATE_STORAGE_SLOT)
+#define V8PP_ISOLATE_STORAGE_SLOT 1
+#endif
+
+/// v8::Context embedder data index, used to store pointer to v8pp::context
+#if !defined(V8PP_CONTEXT_DATA_SLOT)
+#define V8PP_CONTEXT_DATA_SLOT 1
+#endif
+
 /// v8pp plugin initialization procedure name
 #if !defined(V8PP_PLUGIN_INIT_PROC_NAME)
 #define V8PP_PLUGIN_INIT_PROC_NAME v8pp_module_init
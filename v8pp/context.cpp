@@ -2,40 +2,247 @@
 #include "v8pp/config.hpp"
 #include "v8pp/convert.hpp"
 #include "v8pp/function.hpp"
+#include "v8pp/finalizer.hpp"
+#include "v8pp/isolate_data.hpp"
 #include "v8pp/module.hpp"
+#include "v8pp/plugin_registry.hpp"
 #include "v8pp/throw_ex.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <mutex>
 
 #if defined(WIN32)
-#include <windows.h>
 static char const path_sep = '\\';
 #else
-#include <dlfcn.h>
 static char const path_sep = '/';
 #endif
 
-#define STRINGIZE(s) STRINGIZE0(s)
-#define STRINGIZE0(s) #s
-
 namespace v8pp {
 
-struct context::dynamic_module
+static std::string read_file(std::string const& filename)
+{
+	std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!stream)
+	{
+		throw std::runtime_error("could not locate file " + filename);
+	}
+
+	// read the file in chunks to avoid istreambuf_iterator per-char overhead
+	std::string source;
+	char chunk[64 * 1024];
+	while (stream.read(chunk, sizeof(chunk)) || stream.gcount() > 0)
+	{
+		source.append(chunk, static_cast<size_t>(stream.gcount()));
+	}
+	return source;
+}
+
+// process-wide ArrayBuffer allocator set by a context
+static std::atomic<v8::ArrayBuffer::Allocator*> array_buffer_allocator_(nullptr);
+
+static void set_array_buffer_allocator(v8::ArrayBuffer::Allocator* allocator)
 {
-	void* handle;
-	v8::UniquePersistent<v8::Value> exports;
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
 
-	dynamic_module() = default;
-	dynamic_module(dynamic_module&& other)
-		: handle(other.handle)
-		, exports(std::move(other.exports))
+	v8::ArrayBuffer::Allocator* const current = array_buffer_allocator_;
+	if (current == allocator)
 	{
-		other.handle = nullptr;
+		return;
 	}
+	if (current)
+	{
+		throw std::runtime_error("context: another ArrayBuffer allocator is already set");
+	}
+	v8::V8::SetArrayBufferAllocator(allocator);
+	array_buffer_allocator_ = allocator;
+}
+
+namespace detail {
 
-	dynamic_module(dynamic_module const&) = delete;
+// JavaScript modules compiled in an isolate, shared by its contexts
+struct script_cache
+{
+	explicit script_cache(v8::Isolate*) {}
+
+	std::map<std::string, persistent<v8::UnboundScript>> scripts;
+};
+
+// Heap limit GC callback, registered once for all contexts of an isolate
+struct heap_limit_hook
+{
+	explicit heap_limit_hook(v8::Isolate*) : users(0) {}
+
+	size_t users;
 };
 
+} // namespace detail
+
+namespace {
+
+bool is_path_sep(char c)
+{
+	return c == '/' || c == '\\';
+}
+
+bool is_relative_path(std::string const& name)
+{
+	return name.compare(0, 2, "./") == 0 || name.compare(0, 3, "../") == 0
+		|| name.compare(0, 2, ".\\") == 0 || name.compare(0, 3, "..\\") == 0;
+}
+
+bool is_absolute_path(std::string const& name)
+{
+	return (!name.empty() && is_path_sep(name[0]))
+		|| (name.size() > 1 && name[1] == ':');
+}
+
+bool is_script_name(std::string const& name)
+{
+	static std::string const suffix = ".js";
+	return is_relative_path(name) || (name.size() >= suffix.size()
+		&& name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+std::string dirname(std::string const& filename)
+{
+	size_t const pos = filename.find_last_of("/\\");
+	return pos != filename.npos? filename.substr(0, pos) : std::string();
+}
+
+// collapse `.` and `..` path segments, so a module has one cache key
+std::string normalize_path(std::string const& path)
+{
+	std::vector<std::string> segments;
+	size_t begin = 0;
+	bool const absolute = !path.empty() && is_path_sep(path[0]);
+	while (begin <= path.size())
+	{
+		size_t end = begin;
+		while (end < path.size() && !is_path_sep(path[end]))
+		{
+			++end;
+		}
+		std::string const segment = path.substr(begin, end - begin);
+		if (segment == ".." && !segments.empty() && segments.back() != "..")
+		{
+			segments.pop_back();
+		}
+		else if (!segment.empty() && segment != ".")
+		{
+			segments.push_back(segment);
+		}
+		begin = end + 1;
+	}
+
+	std::string result = absolute? std::string(1, path_sep) : std::string();
+	for (size_t i = 0; i < segments.size(); ++i)
+	{
+		if (i) result += path_sep;
+		result += segments[i];
+	}
+	return result;
+}
+
+} // unnamed namespace
+
+async_script::async_script(context& ctx, std::string const& filename)
+	: ctx_(&ctx)
+	, filename_(filename)
+	, source_(std::async(std::launch::async, &read_file, filename).share())
+{
+}
+
+async_script::async_script(async_script&& src)
+	: ctx_(src.ctx_)
+	, filename_(std::move(src.filename_))
+	, source_(std::move(src.source_))
+	, script_(std::move(src.script_))
+{
+	src.ctx_ = nullptr;
+}
+
+async_script& async_script::operator=(async_script&& src)
+{
+	if (&src != this)
+	{
+		ctx_ = src.ctx_;
+		src.ctx_ = nullptr;
+		filename_ = std::move(src.filename_);
+		source_ = std::move(src.source_);
+		script_ = std::move(src.script_);
+	}
+	return *this;
+}
+
+bool async_script::ready() const
+{
+	return !script_.IsEmpty() || (source_.valid()
+		&& source_.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+}
+
+void async_script::wait()
+{
+	if (script_.IsEmpty())
+	{
+		if (!source_.valid())
+		{
+			throw std::runtime_error("async_script: no script source for " + filename_);
+		}
+		// rethrows a file read error
+		source_.get();
+	}
+}
+
+bool async_script::compile()
+{
+	if (!script_.IsEmpty())
+	{
+		return true;
+	}
+	if (!ctx_ || !source_.valid())
+	{
+		throw std::runtime_error("async_script: no script source for " + filename_);
+	}
+
+	v8::Isolate* isolate = ctx_->isolate();
+	v8::HandleScope scope(isolate);
+
+	// rethrows a file read error
+	std::string const& source = source_.get();
+
+	v8::ScriptCompiler::Source script_source(to_v8(isolate, source),
+		v8::ScriptOrigin(to_v8(isolate, filename_)));
+	v8::Local<v8::UnboundScript> script = v8::ScriptCompiler::CompileUnbound(isolate, &script_source);
+	if (script.IsEmpty())
+	{
+		return false;
+	}
+	script_.Reset(isolate, script);
+	source_ = std::shared_future<std::string>();
+	return true;
+}
+
+v8::Handle<v8::Value> async_script::run()
+{
+	v8::Isolate* isolate = ctx_? ctx_->isolate() : nullptr;
+	if (!isolate)
+	{
+		throw std::runtime_error("async_script: no context for " + filename_);
+	}
+
+	v8::EscapableHandleScope scope(isolate);
+
+	v8::Local<v8::Value> result;
+	if (compile())
+	{
+		result = ctx_->run(to_local(isolate, script_)->BindToCurrentContext());
+	}
+	return scope.Escape(result);
+}
+
 void context::load_module(v8::FunctionCallbackInfo<v8::Value> const& args)
 {
 	v8::Isolate* isolate = args.GetIsolate();
@@ -50,57 +257,28 @@ void context::load_module(v8::FunctionCallbackInfo<v8::Value> const& args)
 			throw std::runtime_error("load_module: require module name string argument");
 		}
 
-		context* ctx = detail::get_external_data<context*>(args.Data());
-		context::dynamic_modules::iterator it = ctx->modules_.find(name);
-
-		// check if module is already loaded
-		if (it != ctx->modules_.end())
+		// require() in a JavaScript module has the module directory as data
+		context* ctx;
+		std::string base_dir;
+		if (args.Data()->IsString())
 		{
-			result = v8::Local<v8::Value>::New(isolate, it->second.exports);
+			ctx = static_cast<context*>(isolate->GetCurrentContext()
+				->GetAlignedPointerFromEmbedderData(V8PP_CONTEXT_DATA_SLOT));
+			base_dir = from_v8<std::string>(isolate, args.Data());
 		}
 		else
 		{
-			std::string filename = name;
-			if (!ctx->lib_path_.empty())
-			{
-				filename = ctx->lib_path_ + path_sep + name;
-			}
-			std::string const suffix = V8PP_PLUGIN_SUFFIX;
-			if (filename.size() >= suffix.size()
-				&& filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) != 0)
-			{
-				filename += suffix;
-			}
-
-			dynamic_module module;
-#if defined(WIN32)
-			UINT const prev_error_mode = SetErrorMode(SEM_NOOPENFILEERRORBOX);
-			module.handle = LoadLibraryA(filename.c_str());
-			::SetErrorMode(prev_error_mode);
-#else
-			module.handle = dlopen(filename.c_str(), RTLD_LAZY);
-#endif
-
-			if (!module.handle)
-			{
-				throw std::runtime_error("load_module(" + name + "): could not load shared library " + filename);
-			}
-#if defined(WIN32)
-			void *sym = ::GetProcAddress((HMODULE)module.handle, STRINGIZE(V8PP_PLUGIN_INIT_PROC_NAME));
-#else
-			void *sym = dlsym(module.handle, STRINGIZE(V8PP_PLUGIN_INIT_PROC_NAME));
-#endif
-			if (!sym)
-			{
-				throw std::runtime_error("load_module(" + name + "): initialization function "
-					STRINGIZE(V8PP_PLUGIN_INIT_PROC_NAME) " not found in " + filename);
-			}
+			ctx = detail::get_external_data<context*>(args.Data());
+			base_dir = ctx->lib_path_;
+		}
 
-			using module_init_proc = v8::Handle<v8::Value>(*)(v8::Isolate*);
-			module_init_proc init_proc = reinterpret_cast<module_init_proc>(sym);
-			result = init_proc(isolate);
-			module.exports.Reset(isolate, result);
-			ctx->modules_.emplace(name, std::move(module));
+		try
+		{
+			result = ctx->require_module(name, base_dir);
+		}
+		catch (std::exception const& ex)
+		{
+			throw std::runtime_error("load_module(" + name + "): " + ex.what());
 		}
 	}
 	catch (std::exception const& ex)
@@ -134,12 +312,21 @@ void context::run_file(v8::FunctionCallbackInfo<v8::Value> const& args)
 	args.GetReturnValue().Set(scope.Escape(result));
 }
 
-context::context(v8::Isolate* isolate)
+context::context(v8::Isolate* isolate, context_options const& options)
+	: options_(options)
+	, run_scope_(nullptr)
 {
+	if (options_.array_buffer_allocator)
+	{
+		set_array_buffer_allocator(options_.array_buffer_allocator);
+	}
+
 	own_isolate_ = (isolate == nullptr);
+	entered_ = false;
 	if (own_isolate_)
 	{
 		isolate = v8::Isolate::New();
+		v8::SetResourceConstraints(isolate, &options_.resource_constraints);
 		isolate->Enter();
 	}
 	isolate_ = isolate;
@@ -153,38 +340,84 @@ context::context(v8::Isolate* isolate)
 	global->Set(isolate_, "run", v8::FunctionTemplate::New(isolate_, context::run_file, data));
 
 	v8::Handle<v8::Context> impl = v8::Context::New(isolate_, nullptr, global);
+	impl->SetAlignedPointerInEmbedderData(V8PP_CONTEXT_DATA_SLOT, this);
 	impl->Enter();
 	impl_.Reset(isolate_, impl);
+	entered_ = true;
+
+	if (options_.heap_limit)
+	{
+		detail::heap_limit_hook& hook = detail::isolate_data::get<detail::heap_limit_hook>(isolate_);
+		if (hook.users++ == 0)
+		{
+			isolate_->AddGCEpilogueCallback(&context::check_heap_limit);
+		}
+	}
+	if (options_.gc_stats)
+	{
+		enable_gc_stats(isolate_);
+	}
+	autorun_microtasks_ = isolate_->WillAutorunMicrotasks();
+	if (options_.microtasks == microtask_policy::manual)
+	{
+		isolate_->SetAutorunMicrotasks(false);
+	}
 }
 
 context::~context()
 {
-	for (auto& kv : modules_)
+	if (options_.heap_limit)
 	{
-		dynamic_module& module = kv.second;
-		module.exports.Reset();
-		if (module.handle)
+		detail::heap_limit_hook* hook = detail::isolate_data::find<detail::heap_limit_hook>(isolate_);
+		if (hook && --hook->users == 0)
 		{
-#if defined(WIN32)
-			::FreeLibrary((HMODULE)module.handle);
-#else
-			dlclose(module.handle);
-#endif
+			isolate_->RemoveGCEpilogueCallback(&context::check_heap_limit);
 		}
 	}
-	modules_.clear();
+	if (options_.microtasks == microtask_policy::manual)
+	{
+		// restore the policy for other users of a shared isolate
+		isolate_->SetAutorunMicrotasks(autorun_microtasks_);
+	}
+	if (options_.gc_stats)
+	{
+		disable_gc_stats(isolate_);
+	}
 
-	v8::Local<v8::Context> impl = to_local(isolate_, impl_);
-	impl->Exit();
+	scripts_.clear();
+
+	if (entered_)
+	{
+		exit();
+	}
 
 	impl_.Reset();
 	if (own_isolate_)
 	{
+		release_isolate_data(isolate_);
 		isolate_->Exit();
 		isolate_->Dispose();
 	}
 }
 
+void context::enter()
+{
+	if (!entered_)
+	{
+		to_local(isolate_, impl_)->Enter();
+		entered_ = true;
+	}
+}
+
+void context::exit()
+{
+	if (entered_)
+	{
+		to_local(isolate_, impl_)->Exit();
+		entered_ = false;
+	}
+}
+
 context& context::set(char const* name, v8::Handle<v8::Value> value)
 {
 	v8::HandleScope scope(isolate_);
@@ -199,14 +432,119 @@ context& context::set(char const* name, module& m)
 
 v8::Handle<v8::Value> context::run_file(std::string const& filename)
 {
-	std::ifstream stream(filename.c_str());
-	if (!stream)
+	return run_script(read_file(filename), filename);
+}
+
+v8::Handle<v8::Value> context::require(std::string const& name)
+{
+	return require_module(name, lib_path_);
+}
+
+v8::Local<v8::Value> context::require_module(std::string const& name, std::string const& base_dir)
+{
+	// plugins are looked up in the cached lib_path listing
+	if (!is_script_name(name) && !plugin_registry::instance().find(lib_path_, name).empty())
 	{
-		throw std::runtime_error("could not locate file " + filename);
+		return require_plugin(isolate_, lib_path_, name);
 	}
 
-	std::istreambuf_iterator<char> begin(stream), end;
-	return run_script(std::string(begin, end), filename);
+	std::string filename = name;
+	if (is_relative_path(name))
+	{
+		filename = base_dir.empty()? name : base_dir + path_sep + name;
+	}
+	else if (!is_absolute_path(name) && !lib_path_.empty())
+	{
+		filename = lib_path_ + path_sep + name;
+	}
+	if (filename.size() < 3 || filename.compare(filename.size() - 3, 3, ".js") != 0)
+	{
+		filename += ".js";
+	}
+	return require_script(normalize_path(filename));
+}
+
+v8::Local<v8::Value> context::require_script(std::string const& filename)
+{
+	v8::EscapableHandleScope scope(isolate_);
+
+	v8::Local<v8::String> const exports_name = to_v8(isolate_, "exports");
+
+	// module is already evaluated or being evaluated in this context
+	auto it = scripts_.find(filename);
+	if (it != scripts_.end())
+	{
+		return scope.Escape(to_local(isolate_, it->second)->Get(exports_name));
+	}
+
+	// the module is compiled once per isolate
+	detail::script_cache& cache = detail::isolate_data::get<detail::script_cache>(isolate_);
+	auto cached = cache.scripts.find(filename);
+	v8::Local<v8::UnboundScript> script;
+	if (cached != cache.scripts.end())
+	{
+		script = to_local(isolate_, cached->second);
+	}
+	else
+	{
+		std::string const source = "(function (exports, require, module, __filename, __dirname) {"
+			+ read_file(filename) + "\n})";
+		v8::ScriptCompiler::Source script_source(to_v8(isolate_, source),
+			v8::ScriptOrigin(to_v8(isolate_, filename)));
+		script = v8::ScriptCompiler::CompileUnbound(isolate_, &script_source);
+		if (script.IsEmpty())
+		{
+			return v8::Local<v8::Value>();
+		}
+		cache.scripts.emplace(filename, persistent<v8::UnboundScript>(isolate_, script));
+	}
+
+	std::string const dir = dirname(filename);
+	v8::Local<v8::Object> module = v8::Object::New(isolate_);
+	v8::Local<v8::Object> exports = v8::Object::New(isolate_);
+	module->Set(exports_name, exports);
+	module->Set(to_v8(isolate_, "id"), to_v8(isolate_, filename));
+
+	// register the module before evaluation to allow circular dependencies
+	scripts_.emplace(filename, persistent<v8::Object>(isolate_, module));
+
+	v8::Local<v8::Value> args[] =
+	{
+		exports,
+		v8::Function::New(isolate_, &context::load_module, to_v8(isolate_, dir)),
+		module,
+		to_v8(isolate_, filename),
+		to_v8(isolate_, dir),
+	};
+	v8::Local<v8::Value> result;
+	try
+	{
+		result = run([&]() -> v8::Local<v8::Value>
+			{
+				v8::Local<v8::Value> wrapper = script->BindToCurrentContext()->Run();
+				if (wrapper.IsEmpty() || !wrapper->IsFunction())
+				{
+					return v8::Local<v8::Value>();
+				}
+				return wrapper.As<v8::Function>()->Call(global(), 5, args);
+			});
+	}
+	catch (...)
+	{
+		scripts_.erase(filename);
+		throw;
+	}
+	if (result.IsEmpty())
+	{
+		scripts_.erase(filename);
+		return v8::Local<v8::Value>();
+	}
+	return scope.Escape(module->Get(exports_name));
+}
+
+async_script context::load_file(std::string const& filename)
+{
+	return async_script(*this, filename);
 }
 
 v8::Handle<v8::Value> context::run_script(std::string const& source, std::string const& filename)
@@ -219,9 +557,140 @@ v8::Handle<v8::Value> context::run_script(std::string const& source, std::string
 	v8::Local<v8::Value> result;
 	if (!script.IsEmpty())
 	{
-		result = script->Run();
+		result = run(script);
 	}
 	return scope.Escape(result);
 }
 
+v8::ArrayBuffer::Allocator* context::array_buffer_allocator()
+{
+	return array_buffer_allocator_;
+}
+
+bool context::idle(std::chrono::milliseconds idle_time)
+{
+	auto const deadline = std::chrono::steady_clock::now() + idle_time;
+
+	// destroy objects finalized by GC with deferred policy first
+	run_finalizers(isolate_, deadline);
+
+	for (;;)
+	{
+		auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now());
+		if (left.count() <= 0)
+		{
+			return false;
+		}
+		if (v8::V8::IdleNotification(static_cast<int>(left.count())))
+		{
+			return true;
+		}
+	}
+}
+
+void context::memory_pressure(memory_pressure_level level)
+{
+	switch (level)
+	{
+	case memory_pressure_level::none:
+		break;
+	case memory_pressure_level::moderate:
+		// large idle time hint lets V8 finish incremental marking and sweeping
+		v8::V8::IdleNotification(1000);
+		break;
+	case memory_pressure_level::critical:
+		v8::V8::LowMemoryNotification();
+		break;
+	}
+}
+
+void context::run_microtasks()
+{
+	auto const start = std::chrono::steady_clock::now();
+	// microtasks are script runs too, watch them for the limits
+	run([this]()
+		{
+			isolate_->RunMicrotasks();
+			return v8::Local<v8::Value>();
+		});
+	++microtask_stats_.checkpoints;
+	microtask_stats_.duration.add(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count());
+}
+
+void context::set_time_limits(std::chrono::milliseconds wall_time, std::chrono::milliseconds cpu_time)
+{
+	options_.wall_time_limit = wall_time;
+	options_.cpu_time_limit = cpu_time;
+}
+
+v8::Local<v8::Value> context::run(v8::Local<v8::Script> script)
+{
+	return run([script]() { return script->Run(); });
+}
+
+template<typename Run>
+v8::Local<v8::Value> context::run(Run func)
+{
+	// nested runs, such as run() from JavaScript, are watched by the outermost one
+	bool const watched = !run_scope_ && (options_.heap_limit
+		|| options_.wall_time_limit.count() || options_.cpu_time_limit.count());
+	if (!watched)
+	{
+		return func();
+	}
+
+	watchdog::scope run_scope(watchdog::instance(), isolate_,
+		options_.wall_time_limit, options_.cpu_time_limit);
+
+	// reset run_scope_ also when func() throws
+	struct run_scope_guard
+	{
+		watchdog::scope*& ptr;
+		~run_scope_guard() { ptr = nullptr; }
+	} const guard = { run_scope_ };
+	run_scope_ = &run_scope;
+
+	v8::Local<v8::Value> result = func();
+
+	if (char const* reason = run_scope.reason())
+	{
+		throw std::runtime_error(std::string("script terminated: ") + reason);
+	}
+	return result;
+}
+
+bool context::cancelled(v8::Isolate* isolate)
+{
+	if (!isolate->InContext())
+	{
+		return false;
+	}
+	v8::HandleScope scope(isolate);
+	context const* ctx = static_cast<context const*>(
+		isolate->GetCurrentContext()->GetAlignedPointerFromEmbedderData(V8PP_CONTEXT_DATA_SLOT));
+	return ctx && ctx->cancelled();
+}
+
+void context::check_heap_limit(v8::Isolate* isolate, v8::GCType, v8::GCCallbackFlags)
+{
+	if (!isolate->InContext())
+	{
+		return;
+	}
+	v8::HandleScope scope(isolate);
+	context* ctx = static_cast<context*>(
+		isolate->GetCurrentContext()->GetAlignedPointerFromEmbedderData(V8PP_CONTEXT_DATA_SLOT));
+	if (ctx && ctx->run_scope_ && ctx->options_.heap_limit)
+	{
+		v8::HeapStatistics stats;
+		isolate->GetHeapStatistics(&stats);
+		if (stats.used_heap_size() > ctx->options_.heap_limit)
+		{
+			ctx->run_scope_->terminate("heap limit exceeded");
+		}
+	}
+}
+
 } // namespace v8pp
@@ -1,12 +1,17 @@
 #ifndef V8PP_CONTEXT_HPP_INCLUDED
 #define V8PP_CONTEXT_HPP_INCLUDED
 
+#include <chrono>
 #include <string>
 #include <map>
+#include <future>
 
 #include <v8.h>
 
 #include "v8pp/convert.hpp"
+#include "v8pp/heap_stats.hpp"
+#include "v8pp/persistent.hpp"
+#include "v8pp/watchdog.hpp"
 
 namespace v8pp {
 
@@ -15,17 +20,180 @@ class module;
 template<typename T>
 class class_;
 
+class context;
+
+/// Script file being read in a background thread, see context::load_file()
+class async_script
+{
+public:
+	async_script(async_script&& src);
+	async_script& operator=(async_script&& src);
+
+	async_script(async_script const&) = delete;
+	async_script& operator=(async_script const&) = delete;
+
+	/// Script filename
+	std::string const& filename() const { return filename_; }
+
+	/// Is the script source read, so compile() and run() would not block
+	bool ready() const;
+
+	/// Wait until the script source is read,
+	/// rethrows an exception occurred while reading the file
+	void wait();
+
+	/// Compile the script source, waiting for it to be read.
+	/// Rethrows an exception occurred while reading the file.
+	/// Returns false on compilation error, use v8::TryCatch around it to find out why.
+	/// Must be invoked in a v8::HandleScope
+	bool compile();
+
+	/// Run the script, compiling it if it was not compiled yet.
+	/// Returns script result or empty handle on failure, see context::run_file()
+	v8::Handle<v8::Value> run();
+
+private:
+	friend class context;
+	async_script(context& ctx, std::string const& filename);
+
+	context* ctx_;
+	std::string filename_;
+	// shared to rethrow a read error and recompile on each call
+	std::shared_future<std::string> source_;
+	persistent<v8::UnboundScript> script_;
+};
+
+/// Memory pressure level, see context::memory_pressure()
+enum class memory_pressure_level
+{
+	/// No memory pressure
+	none,
+	/// Memory is getting low, V8 should do more GC work
+	moderate,
+	/// Memory is critically low, V8 should free as much memory as possible
+	critical,
+};
+
+/// Microtask (promise callback) execution policy, see context_options::microtasks
+enum class microtask_policy
+{
+	/// V8 runs microtasks when the outermost script run returns
+	automatic,
+	/// Microtasks run only in context::run_microtasks() checkpoints
+	manual,
+};
+
+/// Microtask checkpoint statistics, see context::run_microtasks()
+struct microtask_stats
+{
+	/// Number of run_microtasks() checkpoints
+	uint64_t checkpoints = 0;
+	/// Checkpoint durations, in microseconds
+	histogram duration;
+};
+
+/// Context creation options
+struct context_options
+{
+	/// Heap constraints applied to the isolate created by the context,
+	/// zero values leave V8 defaults
+	v8::ResourceConstraints resource_constraints;
+
+	/// Terminate a script run when the used heap size after garbage collection
+	/// exceeds this limit in bytes, 0 means no limit. Should be less than the
+	/// V8 heap size limit to fail the run before V8 runs out of memory.
+	size_t heap_limit = 0;
+
+	/// Wall time limit of a script run, 0 means no limit
+	std::chrono::milliseconds wall_time_limit = std::chrono::milliseconds(0);
+
+	/// CPU time limit of a script run, 0 means no limit
+	std::chrono::milliseconds cpu_time_limit = std::chrono::milliseconds(0);
+
+	/// Collect GC statistics in the isolate while the context exists,
+	/// see context::gc_statistics()
+	bool gc_stats = false;
+
+	/// Microtask policy, applied to the whole isolate while the context exists
+	microtask_policy microtasks = microtask_policy::automatic;
+
+	/// ArrayBuffer allocator, such as v8pp::pooled_allocator.
+	/// V8 has one allocator per process, it is set on the first context
+	/// creation and must outlive all isolates. Contexts created later
+	/// should use the same allocator or nullptr.
+	v8::ArrayBuffer::Allocator* array_buffer_allocator = nullptr;
+};
+
 /// V8 isolate and context wrapper
 class context
 {
 public:
 	/// Create context with optional existing v8::Isolate
-	explicit context(v8::Isolate* isolate = nullptr);
+	explicit context(v8::Isolate* isolate = nullptr, context_options const& options = context_options());
 	~context();
 
+	/// Context options
+	context_options const& options() const { return options_; }
+
+	/// Set wall and CPU time limits for subsequent script runs, 0 means no limit.
+	/// A script exceeding the limits is terminated and run_script() or run_file()
+	/// throws std::runtime_error.
+	void set_time_limits(std::chrono::milliseconds wall_time, std::chrono::milliseconds cpu_time);
+
+	/// Is the current script run terminated by the watchdog
+	bool cancelled() const { return run_scope_ && run_scope_->terminated(); }
+
+	/// Is the current script run in the isolate terminated by the watchdog,
+	/// cheap check for long-running native functions.
+	/// The isolate current context should be created by v8pp::context.
+	static bool cancelled(v8::Isolate* isolate);
+
+	/// Notify V8 the isolate is idle for the time, to perform GC work
+	/// outside of script runs, and destroy objects queued for deferred finalization.
+	/// Returns true when V8 has no more GC work to do.
+	/// The isolate should be entered in the current thread.
+	bool idle(std::chrono::milliseconds idle_time);
+
+	/// Notify V8 about memory pressure: moderate pressure allows V8 to complete
+	/// pending GC work, critical pressure performs a full GC freeing as much
+	/// memory as possible. The isolate should be entered in the current thread.
+	void memory_pressure(memory_pressure_level level);
+
+	/// Run pending microtasks in the isolate, a checkpoint after a batch
+	/// of calls with microtask_policy::manual. Must be invoked in a v8::HandleScope
+	void run_microtasks();
+
+	/// Microtask checkpoint statistics of the context
+	microtask_stats const& microtask_statistics() const { return microtask_stats_; }
+
+	/// Heap statistics of the isolate
+	heap_stats heap_statistics() { return get_heap_stats(isolate_); }
+
+	/// GC statistics of the isolate, collected when enabled
+	/// with context_options::gc_stats or enable_gc_stats()
+	gc_stats gc_statistics() { return get_gc_stats(isolate_); }
+
+	/// ArrayBuffer allocator set with context_options, nullptr if none
+	static v8::ArrayBuffer::Allocator* array_buffer_allocator();
+
 	/// V8 isolate associated with this context
 	v8::Isolate* isolate() { return isolate_; }
 
+	/// V8 context handle
+	v8::Local<v8::Context> impl() { return to_local(isolate_, impl_); }
+
+	/// Global object of the context
+	v8::Local<v8::Object> global() { return impl()->Global(); }
+
+	/// Enter the V8 context, it is entered on creation
+	void enter();
+
+	/// Exit the V8 context, contexts should be exited in reverse order of entering
+	void exit();
+
+	/// Is the V8 context entered
+	bool entered() const { return entered_; }
+
 	/// Library search path
 	std::string const& lib_path() const { return lib_path_; }
 
@@ -37,6 +205,21 @@ public:
 	/// Must be invoked in a v8::HandleScope
 	v8::Handle<v8::Value> run_file(std::string const& filename);
 
+	/// Start reading script file in a background thread, returns a handle
+	/// to compile and to run the script when its source has been read.
+	/// The returned handle must not outlive the context.
+	async_script load_file(std::string const& filename);
+
+	/// Require a module by name, the same as require() in JavaScript.
+	/// A name ending with `.js` or starting with `./` or `../` is a JavaScript
+	/// module, other names are plugins in lib_path or JavaScript modules if
+	/// no such plugin exists. JavaScript modules are CommonJS-like: they are
+	/// compiled once per isolate and evaluated once per context.
+	/// Returns module exports or empty handle on failure, use v8::TryCatch
+	/// around it to find out why. Throws std::runtime_error if the module is
+	/// not found. Must be invoked in a v8::HandleScope
+	v8::Handle<v8::Value> require(std::string const& name);
+
 	/// The same as run_file but uses string as the script source
 	v8::Handle<v8::Value> run_script(std::string const& source, std::string const& filename = "");
 
@@ -56,17 +239,31 @@ public:
 	}
 
 private:
+	friend class async_script;
+
+	v8::Local<v8::Value> run(v8::Local<v8::Script> script);
+
+	template<typename Run>
+	v8::Local<v8::Value> run(Run func);
+
+	v8::Local<v8::Value> require_module(std::string const& name, std::string const& base_dir);
+	v8::Local<v8::Value> require_script(std::string const& filename);
+	static void check_heap_limit(v8::Isolate* isolate, v8::GCType type, v8::GCCallbackFlags flags);
+
 	bool own_isolate_;
+	bool entered_;
 	v8::Isolate* isolate_;
 	v8::Persistent<v8::Context> impl_;
 
-	struct dynamic_module;
-	using dynamic_modules = std::map<std::string, dynamic_module>;
+	context_options options_;
+	watchdog::scope* run_scope_;
+	microtask_stats microtask_stats_;
+	bool autorun_microtasks_; // isolate policy before the context creation
 
 	static void load_module(v8::FunctionCallbackInfo<v8::Value> const& args);
 	static void run_file(v8::FunctionCallbackInfo<v8::Value> const& args);
 
-	dynamic_modules modules_;
+	std::map<std::string, persistent<v8::Object>> scripts_;
 	std::string lib_path_;
 };
 
@@ -0,0 +1,244 @@
+#include "v8pp/context_pool.hpp"
+#include "v8pp/convert.hpp"
+#include "v8pp/isolate_data.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace v8pp {
+
+struct context_pool::entry
+{
+	std::unique_ptr<context> ctx;
+	size_t uses;
+
+	// global object properties after initialization, restored on recycle
+	std::map<std::string, persistent<v8::Value>> globals;
+
+	explicit entry(v8::Isolate* isolate)
+		: ctx(new context(isolate))
+		, uses(0)
+	{
+	}
+};
+
+context_pool::context_pool(v8::Isolate* isolate, size_t size, init_function init, size_t max_uses)
+	: capacity_(size)
+	, max_uses_(max_uses)
+	, init_(init)
+	, active_(0)
+{
+	own_isolate_ = (isolate == nullptr);
+	if (own_isolate_)
+	{
+		isolate = v8::Isolate::New();
+		isolate->Enter();
+	}
+	isolate_ = isolate;
+
+	v8::HandleScope scope(isolate_);
+
+	idle_.reserve(capacity_);
+	for (size_t i = 0; i < capacity_; ++i)
+	{
+		idle_.emplace_back(create());
+	}
+}
+
+context_pool::~context_pool()
+{
+	// leases refer to the pool and return their contexts on destruction
+	assert(active_ == 0 && "context_pool destroyed with active leases");
+
+	while (!idle_.empty())
+	{
+		destroy(std::move(idle_.back()));
+		idle_.pop_back();
+	}
+
+	if (own_isolate_)
+	{
+		release_isolate_data(isolate_);
+		isolate_->Exit();
+		isolate_->Dispose();
+	}
+}
+
+std::unique_ptr<context_pool::entry> context_pool::create()
+{
+	v8::HandleScope scope(isolate_);
+
+	std::unique_ptr<entry> e(new entry(isolate_));
+	if (init_)
+	{
+		init_(*e->ctx);
+	}
+
+	// remember the initialized global object state
+	v8::Local<v8::Object> global = e->ctx->global();
+	v8::Local<v8::Array> names = global->GetOwnPropertyNames();
+	for (uint32_t i = 0, count = names->Length(); i < count; ++i)
+	{
+		v8::Local<v8::Value> name = names->Get(i);
+		e->globals.emplace(from_v8<std::string>(isolate_, name->ToString()),
+			persistent<v8::Value>(isolate_, global->Get(name)));
+	}
+
+	e->ctx->exit();
+	return e;
+}
+
+void context_pool::recycle(entry& e)
+{
+	v8::HandleScope scope(isolate_);
+
+	if (reset_)
+	{
+		reset_(*e.ctx);
+	}
+
+	v8::Local<v8::Object> global = e.ctx->global();
+
+	// delete globals added while the context was in use
+	v8::Local<v8::Array> names = global->GetOwnPropertyNames();
+	for (uint32_t i = 0, count = names->Length(); i < count; ++i)
+	{
+		v8::Local<v8::Value> name = names->Get(i);
+		if (e.globals.find(from_v8<std::string>(isolate_, name->ToString())) == e.globals.end())
+		{
+			global->ForceDelete(name);
+		}
+	}
+
+	// restore overwritten initial globals
+	for (auto const& kv : e.globals)
+	{
+		v8::Handle<v8::String> name = to_v8(isolate_, kv.first);
+		v8::Local<v8::Value> value = to_local(isolate_, kv.second);
+		if (!global->Get(name)->StrictEquals(value))
+		{
+			global->ForceSet(name, value);
+		}
+	}
+}
+
+context_pool::lease context_pool::acquire()
+{
+	std::unique_ptr<entry> e;
+	if (idle_.empty())
+	{
+		e = create();
+	}
+	else
+	{
+		e = std::move(idle_.back());
+		idle_.pop_back();
+	}
+	++e->uses;
+	e->ctx->enter();
+	++active_;
+	return lease(*this, std::move(e));
+}
+
+void context_pool::release(std::unique_ptr<entry> e, bool discard)
+{
+	--active_;
+	if (discard || (max_uses_ && e->uses >= max_uses_) || idle_.size() >= capacity_)
+	{
+		destroy(std::move(e));
+	}
+	else
+	{
+		try
+		{
+			recycle(*e);
+			e->ctx->exit();
+			idle_.emplace_back(std::move(e));
+		}
+		catch (std::exception const&)
+		{
+			destroy(std::move(e));
+		}
+	}
+}
+
+bool context_pool::idle(std::chrono::milliseconds idle_time)
+{
+	// an active lease may be running a script in the isolate
+	if (active_ || idle_.empty())
+	{
+		return false;
+	}
+	return idle_.back()->ctx->idle(idle_time);
+}
+
+void context_pool::destroy(std::unique_ptr<entry> e)
+{
+	v8::HandleScope scope(isolate_);
+
+	for (auto& kv : e->globals)
+	{
+		kv.second.Reset();
+	}
+	// context exits itself on destruction if it was entered
+	e->ctx.reset();
+}
+
+context_pool::lease::lease(context_pool& pool, std::unique_ptr<entry> e)
+	: pool_(&pool)
+	, entry_(std::move(e))
+{
+}
+
+context_pool::lease::lease(lease&& src)
+	: pool_(src.pool_)
+	, entry_(std::move(src.entry_))
+{
+	src.pool_ = nullptr;
+}
+
+context_pool::lease& context_pool::lease::operator=(lease&& src)
+{
+	if (&src != this)
+	{
+		release();
+		pool_ = src.pool_;
+		src.pool_ = nullptr;
+		entry_ = std::move(src.entry_);
+	}
+	return *this;
+}
+
+context_pool::lease::~lease()
+{
+	release();
+}
+
+context& context_pool::lease::get() const
+{
+	if (!entry_)
+	{
+		throw std::runtime_error("context_pool: lease has no context");
+	}
+	return *entry_->ctx;
+}
+
+void context_pool::lease::release()
+{
+	if (pool_ && entry_)
+	{
+		pool_->release(std::move(entry_), false);
+	}
+	pool_ = nullptr;
+}
+
+void context_pool::lease::discard()
+{
+	if (pool_ && entry_)
+	{
+		pool_->release(std::move(entry_), true);
+	}
+	pool_ = nullptr;
+}
+
+} // namespace v8pp
@@ -0,0 +1,129 @@
+#ifndef V8PP_CONTEXT_POOL_HPP_INCLUDED
+#define V8PP_CONTEXT_POOL_HPP_INCLUDED
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/context.hpp"
+#include "v8pp/persistent.hpp"
+
+namespace v8pp {
+
+/// Pool of pre-initialized contexts sharing one V8 isolate.
+/// Contexts are created and initialized in advance, handed out with
+/// acquire() and recycled or discarded when the returned lease is released.
+/// Pool contexts are not entered while idle, a lease enters its context.
+/// Like v8::Context::Scope, several active leases should be released
+/// in reverse order of acquiring.
+/// All leases must be released or destroyed before the pool.
+///
+/// Recycling restores only own properties of the global object: globals added
+/// in use are deleted and overwritten ones are restored. Changes inside existing
+/// objects, such as `JSON.foo = 1` or `Array.prototype.x = ...`, remain in the
+/// context for the next lease. Use a reset function to undo them, or max_uses = 1
+/// to get a fresh context for each lease.
+class context_pool
+{
+public:
+	/// Context initialization function, used to bind modules and classes
+	using init_function = std::function<void (context& ctx)>;
+
+	/// Context reset function, used to detach per-request state on recycle
+	using reset_function = std::function<void (context& ctx)>;
+
+	/// Create a pool of `size` contexts with optional existing v8::Isolate,
+	/// each context is initialized with `init` function.
+	/// Contexts are discarded after `max_uses` acquires, 0 means unlimited.
+	context_pool(v8::Isolate* isolate, size_t size, init_function init, size_t max_uses = 0);
+	~context_pool();
+
+	context_pool(context_pool const&) = delete;
+	context_pool& operator=(context_pool const&) = delete;
+
+	class lease;
+
+	/// Get a context from the pool, a new one is created if the pool is empty.
+	/// Must be invoked in a v8::HandleScope
+	lease acquire();
+
+	/// V8 isolate of the pool contexts
+	v8::Isolate* isolate() { return isolate_; }
+
+	/// Number of idle contexts in the pool
+	size_t size() const { return idle_.size(); }
+
+	/// Maximum number of idle contexts kept in the pool
+	size_t capacity() const { return capacity_; }
+
+	/// Number of context uses before it is discarded, 0 means unlimited
+	size_t max_uses() const { return max_uses_; }
+	void set_max_uses(size_t max_uses) { max_uses_ = max_uses; }
+
+	/// Set a function called on a context before it returns to the pool
+	void set_reset(reset_function reset) { reset_ = reset; }
+
+	/// Do GC work for up to idle_time when there are no active leases,
+	/// to be called from the application loop between requests.
+	/// Returns true when V8 has no more GC work to do. See context::idle()
+	bool idle(std::chrono::milliseconds idle_time);
+
+	/// Number of acquired contexts
+	size_t active() const { return active_; }
+
+private:
+	struct entry;
+
+	std::unique_ptr<entry> create();
+	void release(std::unique_ptr<entry> e, bool discard);
+	void recycle(entry& e);
+	void destroy(std::unique_ptr<entry> e);
+
+	bool own_isolate_;
+	v8::Isolate* isolate_;
+	size_t capacity_;
+	size_t max_uses_;
+	init_function init_;
+	reset_function reset_;
+	size_t active_;
+	std::vector<std::unique_ptr<entry>> idle_;
+};
+
+/// A context acquired from the pool, returns it back on destruction
+class context_pool::lease
+{
+public:
+	lease(lease&& src);
+	lease& operator=(lease&& src);
+	~lease();
+
+	lease(lease const&) = delete;
+	lease& operator=(lease const&) = delete;
+
+	/// Acquired context
+	context& get() const;
+	context& operator*() const { return get(); }
+	context* operator->() const { return &get(); }
+
+	/// Return the context to the pool
+	void release();
+
+	/// Destroy the context instead of returning it to the pool
+	void discard();
+
+private:
+	friend class context_pool;
+	lease(context_pool& pool, std::unique_ptr<entry> e);
+
+	context_pool* pool_;
+	std::unique_ptr<entry> entry_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_CONTEXT_POOL_HPP_INCLUDED
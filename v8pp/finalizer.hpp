@@ -0,0 +1,128 @@
+#ifndef V8PP_FINALIZER_HPP_INCLUDED
+#define V8PP_FINALIZER_HPP_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+#include <v8.h>
+
+#include "v8pp/isolate_data.hpp"
+
+namespace v8pp {
+
+/// Destruction of garbage collected C++ objects wrapped in V8,
+/// see class_::set_finalization()
+enum class finalization_policy
+{
+	/// destroy objects in the GC weak callback
+	immediate,
+	/// unlink objects in the GC weak callback and destroy them later
+	/// in run_finalizers(), called by context::idle()
+	deferred,
+};
+
+/// Deferred finalization metrics of an isolate
+struct finalizer_stats
+{
+	size_t queue_depth;
+	size_t max_queue_depth;
+	uint64_t finalized;
+	uint64_t total_latency; // microseconds from GC to destruction
+	uint64_t max_latency;
+};
+
+namespace detail {
+
+/// Per-isolate queue of unlinked objects waiting for destruction,
+/// used in the isolate thread only
+class finalizer_queue
+{
+public:
+	using destroy_function = void (*)(v8::Isolate* isolate, void* object);
+
+	explicit finalizer_queue(v8::Isolate* isolate)
+		: isolate_(isolate)
+	{
+		stats_ = finalizer_stats();
+	}
+
+	~finalizer_queue()
+	{
+		// the isolate is still alive before its disposal
+		run(std::chrono::steady_clock::time_point::max());
+	}
+
+	finalizer_queue(finalizer_queue const&) = delete;
+	finalizer_queue& operator=(finalizer_queue const&) = delete;
+
+	void push(void* object, destroy_function destroy)
+	{
+		queue_.push_back(item{ object, destroy, std::chrono::steady_clock::now() });
+		stats_.queue_depth = queue_.size();
+		stats_.max_queue_depth = std::max(stats_.max_queue_depth, stats_.queue_depth);
+	}
+
+	size_t run(std::chrono::steady_clock::time_point deadline)
+	{
+		size_t count = 0;
+		while (!queue_.empty())
+		{
+			auto const now = std::chrono::steady_clock::now();
+			if (count && now >= deadline)
+			{
+				break;
+			}
+			item const next = queue_.front();
+			queue_.pop_front();
+
+			uint64_t const latency = std::chrono::duration_cast<std::chrono::microseconds>(now - next.queued).count();
+			stats_.total_latency += latency;
+			stats_.max_latency = std::max(stats_.max_latency, latency);
+			++stats_.finalized;
+			stats_.queue_depth = queue_.size();
+			++count;
+
+			next.destroy(isolate_, next.object);
+		}
+		return count;
+	}
+
+	finalizer_stats const& stats() const { return stats_; }
+
+private:
+	struct item
+	{
+		void* object;
+		destroy_function destroy;
+		std::chrono::steady_clock::time_point queued;
+	};
+
+	v8::Isolate* isolate_;
+	std::deque<item> queue_;
+	finalizer_stats stats_;
+};
+
+} // namespace detail
+
+/// Destroy objects queued with finalization_policy::deferred in the isolate
+/// until the deadline, at least one object is destroyed if the queue is not empty.
+/// Returns number of destroyed objects. Must be called in the isolate thread.
+inline size_t run_finalizers(v8::Isolate* isolate,
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max())
+{
+	detail::finalizer_queue* queue = detail::isolate_data::find<detail::finalizer_queue>(isolate);
+	return queue? queue->run(deadline) : 0;
+}
+
+/// Deferred finalization metrics of the isolate
+inline finalizer_stats get_finalizer_stats(v8::Isolate* isolate)
+{
+	detail::finalizer_queue* queue = detail::isolate_data::find<detail::finalizer_queue>(isolate);
+	return queue? queue->stats() : finalizer_stats();
+}
+
+} // namespace v8pp
+
+#endif // V8PP_FINALIZER_HPP_INCLUDED
@@ -0,0 +1,82 @@
+#include "v8pp/handle_table.hpp"
+#include "v8pp/isolate_data.hpp"
+
+namespace v8pp {
+
+handle_table::handle_table(v8::Isolate* isolate)
+	: isolate_(isolate)
+	, size_(0)
+{
+	v8::HandleScope scope(isolate_);
+	values_.Reset(isolate_, v8::Array::New(isolate_));
+}
+
+handle_table::~handle_table()
+{
+	values_.Reset();
+}
+
+handle_table& handle_table::instance(v8::Isolate* isolate)
+{
+	return detail::isolate_data::get<handle_table>(isolate);
+}
+
+handle_table* handle_table::find(v8::Isolate* isolate)
+{
+	return detail::isolate_data::find<handle_table>(isolate);
+}
+
+handle_ref handle_table::add(v8::Handle<v8::Value> value)
+{
+	v8::HandleScope scope(isolate_);
+
+	uint32_t index;
+	if (free_slots_.empty())
+	{
+		index = static_cast<uint32_t>(generations_.size());
+		generations_.push_back(0);
+	}
+	else
+	{
+		index = free_slots_.back();
+		free_slots_.pop_back();
+	}
+
+	uint32_t& generation = generations_[index];
+	++generation;
+	assert(generation & 1);
+
+	v8::Local<v8::Array>::New(isolate_, values_)->Set(index, value);
+	++size_;
+	return handle_ref(index, generation);
+}
+
+v8::Local<v8::Value> handle_table::get(handle_ref ref) const
+{
+	if (!contains(ref))
+	{
+		return v8::Local<v8::Value>();
+	}
+	v8::EscapableHandleScope scope(isolate_);
+	return scope.Escape(v8::Local<v8::Array>::New(isolate_, values_)->Get(ref.index));
+}
+
+bool handle_table::remove(handle_ref ref)
+{
+	if (!contains(ref))
+	{
+		return false;
+	}
+
+	v8::HandleScope scope(isolate_);
+	v8::Local<v8::Array>::New(isolate_, values_)->Set(ref.index, v8::Undefined(isolate_));
+
+	// free slot generation is even, wraps around to skip 0 for empty references
+	uint32_t& generation = generations_[ref.index];
+	generation = (generation + 1 == 0)? 2 : generation + 1;
+	free_slots_.push_back(ref.index);
+	--size_;
+	return true;
+}
+
+} // namespace v8pp
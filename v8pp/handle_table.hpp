@@ -0,0 +1,210 @@
+#ifndef V8PP_HANDLE_TABLE_HPP_INCLUDED
+#define V8PP_HANDLE_TABLE_HPP_INCLUDED
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+#include "v8pp/persistent.hpp"
+
+namespace v8pp {
+
+/// Reference to a value in isolate handle_table.
+/// Generation of a slot is changed when the value is removed,
+/// so a stale reference doesn't refer to a value added later in the slot.
+struct handle_ref
+{
+	uint32_t index;
+	uint32_t generation; // 0 for empty reference
+
+	handle_ref() : index(0), generation(0) {}
+	handle_ref(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+	bool empty() const { return generation == 0; }
+
+	bool operator==(handle_ref const& rhs) const { return index == rhs.index && generation == rhs.generation; }
+	bool operator!=(handle_ref const& rhs) const { return !(*this == rhs); }
+};
+
+/// Per-isolate table of V8 values retained with a single persistent handle
+/// to a JavaScript array, instead of a global handle for each value
+class handle_table
+{
+public:
+	explicit handle_table(v8::Isolate* isolate);
+	~handle_table();
+
+	handle_table(handle_table const&) = delete;
+	handle_table& operator=(handle_table const&) = delete;
+
+	/// Handle table of the isolate, created on first use
+	static handle_table& instance(v8::Isolate* isolate);
+
+	/// Existing handle table of the isolate, may return nullptr
+	static handle_table* find(v8::Isolate* isolate);
+
+	/// V8 isolate of the table
+	v8::Isolate* isolate() { return isolate_; }
+
+	/// Add a value to the table
+	handle_ref add(v8::Handle<v8::Value> value);
+
+	/// Get a value from the table, empty handle for a stale or empty reference
+	v8::Local<v8::Value> get(handle_ref ref) const;
+
+	/// Check the reference refers to a value in the table
+	bool contains(handle_ref ref) const
+	{
+		return ref.index < generations_.size() && ref.generation == generations_[ref.index]
+			&& (generations_[ref.index] & 1);
+	}
+
+	/// Remove a value from the table, return false for a stale or empty reference
+	bool remove(handle_ref ref);
+
+	/// Number of values in the table
+	size_t size() const { return size_; }
+
+	/// Number of slots in the table
+	size_t capacity() const { return generations_.size(); }
+
+private:
+	v8::Isolate* isolate_;
+	persistent<v8::Array> values_;
+	// slot generation is odd for a used slot, even for a free one
+	std::vector<uint32_t> generations_;
+	std::vector<uint32_t> free_slots_;
+	size_t size_;
+};
+
+/// Pointer to C++ object wrapped in V8, like persistent_ptr,
+/// retaining the wrapped object in the isolate handle_table
+template<typename T>
+class table_ptr
+{
+public:
+	/// Create an empty pointer
+	table_ptr()
+		: isolate_()
+		, value_()
+	{
+	}
+
+	/// Create a pointer to a wrapped object, retain it in the handle table
+	explicit table_ptr(v8::Isolate* isolate, T* value)
+		: isolate_()
+		, value_()
+	{
+		reset(isolate, value);
+	}
+
+	/// Create a pointer from V8 Value, retain it in the handle table
+	explicit table_ptr(v8::Isolate* isolate, v8::Handle<v8::Value> handle)
+		: isolate_()
+		, value_()
+	{
+		reset(isolate, from_v8<T*>(isolate, handle));
+	}
+
+	table_ptr(table_ptr&& src)
+		: isolate_(src.isolate_)
+		, value_(src.value_)
+		, ref_(src.ref_)
+	{
+		src.value_ = nullptr;
+		src.ref_ = handle_ref();
+	}
+
+	table_ptr& operator=(table_ptr&& src)
+	{
+		if (&src != this)
+		{
+			reset();
+			swap(src);
+		}
+		return *this;
+	}
+
+	table_ptr(table_ptr const&) = delete;
+	table_ptr& operator=(table_ptr const&) = delete;
+
+	/// On destroy remove the handle table entry only
+	~table_ptr() { reset(); }
+
+	/// Reset with a new pointer to wrapped C++ object, replace the handle table entry for it
+	void reset(v8::Isolate* isolate, T* value)
+	{
+		if (value != value_)
+		{
+			assert((value_ == nullptr) == ref_.empty());
+			if (!ref_.empty())
+			{
+				// the table may be already destroyed on isolate disposal
+				if (handle_table* table = handle_table::find(isolate_))
+				{
+					table->remove(ref_);
+				}
+				ref_ = handle_ref();
+			}
+			isolate_ = isolate;
+			value_ = value;
+			if (value_)
+			{
+				v8::HandleScope scope(isolate_);
+				ref_ = handle_table::instance(isolate_).add(to_v8(isolate_, value_));
+			}
+		}
+	}
+
+	void reset() { reset(nullptr, nullptr); }
+
+	/// Get pointer to the wrapped C++ object
+	T* get() { return value_; }
+	T const* get() const { return value_; }
+
+	/// Handle table entry for the wrapped object
+	handle_ref ref() const { return ref_; }
+
+	typedef T* (table_ptr<T>::*unspecfied_bool_type);
+
+	/// Safe bool cast
+	operator unspecfied_bool_type() const
+	{
+		return value_? &table_ptr<T>::value_ : nullptr;
+	}
+
+	/// Dereference pointer, valid if get() != nullptr
+	T& operator*() { assert(value_); return *value_; }
+	T const& operator*() const { assert(value_); return *value_; }
+
+	T* operator->() { assert(value_); return value_; }
+	T const* operator->() const { assert(value_); return value_; }
+
+	bool operator==(table_ptr const& rhs) const { return value_ == rhs.value_; }
+	bool operator!=(table_ptr const& rhs) const { return value_ != rhs.value_; }
+
+	void swap(table_ptr& rhs)
+	{
+		std::swap(isolate_, rhs.isolate_);
+		std::swap(value_, rhs.value_);
+		std::swap(ref_, rhs.ref_);
+	}
+
+	friend void swap(table_ptr& lhs, table_ptr& rhs)
+	{
+		lhs.swap(rhs);
+	}
+
+private:
+	v8::Isolate* isolate_;
+	T* value_;
+	handle_ref ref_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_HANDLE_TABLE_HPP_INCLUDED
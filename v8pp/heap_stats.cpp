@@ -0,0 +1,225 @@
+#include "v8pp/heap_stats.hpp"
+#include "v8pp/isolate_data.hpp"
+#include "v8pp/object.hpp"
+#include "v8pp/property.hpp"
+
+namespace v8pp {
+
+namespace detail {
+
+// GC statistics collected in an isolate
+struct gc_tracker
+{
+	v8::Isolate* isolate;
+	unsigned enabled;
+	std::chrono::steady_clock::time_point start_time;
+	size_t start_used;
+	gc_stats stats;
+
+	explicit gc_tracker(v8::Isolate* isolate)
+		: isolate(isolate)
+		, enabled(0)
+		, start_used(0)
+	{
+	}
+
+	~gc_tracker()
+	{
+		if (enabled)
+		{
+			isolate->RemoveGCPrologueCallback(&gc_tracker::prologue);
+			isolate->RemoveGCEpilogueCallback(&gc_tracker::epilogue);
+		}
+	}
+
+	static size_t used_heap_size(v8::Isolate* isolate)
+	{
+		v8::HeapStatistics heap;
+		isolate->GetHeapStatistics(&heap);
+		return heap.used_heap_size();
+	}
+
+	static void prologue(v8::Isolate* isolate, v8::GCType, v8::GCCallbackFlags)
+	{
+		gc_tracker* tracker = detail::isolate_data::find<gc_tracker>(isolate);
+		if (tracker)
+		{
+			tracker->start_used = used_heap_size(isolate);
+			tracker->start_time = std::chrono::steady_clock::now();
+		}
+	}
+
+	static void epilogue(v8::Isolate* isolate, v8::GCType type, v8::GCCallbackFlags)
+	{
+		gc_tracker* tracker = detail::isolate_data::find<gc_tracker>(isolate);
+		if (tracker)
+		{
+			uint64_t const pause = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - tracker->start_time).count();
+			size_t const used = used_heap_size(isolate);
+
+			gc_stats& stats = tracker->stats;
+			if (type == v8::kGCTypeScavenge)
+			{
+				++stats.scavenge_count;
+			}
+			else
+			{
+				++stats.mark_sweep_count;
+			}
+			stats.pause.add(pause);
+			stats.reclaimed.add(tracker->start_used > used? tracker->start_used - used : 0);
+			stats.last_pause = pause;
+			stats.last_type = type;
+		}
+	}
+};
+
+} // namespace detail
+
+void histogram::reset()
+{
+	count = sum = max = 0;
+	for (uint64_t& bucket : buckets)
+	{
+		bucket = 0;
+	}
+}
+
+void histogram::add(uint64_t value)
+{
+	size_t bucket = 0;
+	for (uint64_t v = value; v && bucket + 1 < bucket_count; v >>= 1)
+	{
+		++bucket;
+	}
+	++buckets[bucket];
+	++count;
+	sum += value;
+	if (value > max)
+	{
+		max = value;
+	}
+}
+
+void gc_stats::reset()
+{
+	scavenge_count = mark_sweep_count = 0;
+	pause.reset();
+	reclaimed.reset();
+	last_pause = 0;
+	last_type = v8::kGCTypeAll;
+}
+
+heap_stats get_heap_stats(v8::Isolate* isolate)
+{
+	v8::HeapStatistics heap;
+	isolate->GetHeapStatistics(&heap);
+
+	heap_stats result;
+	result.total_heap_size = heap.total_heap_size();
+	result.total_heap_size_executable = heap.total_heap_size_executable();
+	result.total_physical_size = heap.total_physical_size();
+	result.used_heap_size = heap.used_heap_size();
+	result.heap_size_limit = heap.heap_size_limit();
+	return result;
+}
+
+void enable_gc_stats(v8::Isolate* isolate)
+{
+	detail::gc_tracker& tracker = detail::isolate_data::get<detail::gc_tracker>(isolate);
+	if (tracker.enabled++ == 0)
+	{
+		isolate->AddGCPrologueCallback(&detail::gc_tracker::prologue);
+		isolate->AddGCEpilogueCallback(&detail::gc_tracker::epilogue);
+	}
+}
+
+void disable_gc_stats(v8::Isolate* isolate)
+{
+	detail::gc_tracker* tracker = detail::isolate_data::find<detail::gc_tracker>(isolate);
+	if (tracker && tracker->enabled && --tracker->enabled == 0)
+	{
+		isolate->RemoveGCPrologueCallback(&detail::gc_tracker::prologue);
+		isolate->RemoveGCEpilogueCallback(&detail::gc_tracker::epilogue);
+	}
+}
+
+gc_stats get_gc_stats(v8::Isolate* isolate)
+{
+	detail::gc_tracker* tracker = detail::isolate_data::find<detail::gc_tracker>(isolate);
+	return tracker? tracker->stats : gc_stats();
+}
+
+void reset_gc_stats(v8::Isolate* isolate)
+{
+	detail::gc_tracker* tracker = detail::isolate_data::find<detail::gc_tracker>(isolate);
+	if (tracker)
+	{
+		tracker->stats.reset();
+	}
+}
+
+module stats_module(v8::Isolate* isolate)
+{
+	module m(isolate);
+	m.set("heap", property(&get_heap_stats));
+	m.set("gc", property(&get_gc_stats));
+	return m;
+}
+
+convert<heap_stats>::to_type convert<heap_stats>::to_v8(v8::Isolate* isolate, heap_stats const& value)
+{
+	v8::EscapableHandleScope scope(isolate);
+
+	v8::Local<v8::Object> result = v8::Object::New(isolate);
+	set_option(isolate, result, "total_heap_size", value.total_heap_size);
+	set_option(isolate, result, "total_heap_size_executable", value.total_heap_size_executable);
+	set_option(isolate, result, "total_physical_size", value.total_physical_size);
+	set_option(isolate, result, "used_heap_size", value.used_heap_size);
+	set_option(isolate, result, "heap_size_limit", value.heap_size_limit);
+	return scope.Escape(result);
+}
+
+convert<histogram>::to_type convert<histogram>::to_v8(v8::Isolate* isolate, histogram const& value)
+{
+	v8::EscapableHandleScope scope(isolate);
+
+	// trim trailing empty buckets
+	size_t bucket_count = histogram::bucket_count;
+	while (bucket_count > 0 && value.buckets[bucket_count - 1] == 0)
+	{
+		--bucket_count;
+	}
+
+	v8::Local<v8::Object> result = v8::Object::New(isolate);
+	set_option(isolate, result, "count", value.count);
+	set_option(isolate, result, "sum", value.sum);
+	set_option(isolate, result, "max", value.max);
+	set_option(isolate, result, "buckets", v8pp::to_v8(isolate, value.buckets, value.buckets + bucket_count));
+	return scope.Escape(result);
+}
+
+convert<gc_stats>::to_type convert<gc_stats>::to_v8(v8::Isolate* isolate, gc_stats const& value)
+{
+	v8::EscapableHandleScope scope(isolate);
+
+	char const* last_type = "none";
+	switch (value.last_type)
+	{
+	case v8::kGCTypeScavenge: last_type = "scavenge"; break;
+	case v8::kGCTypeMarkSweepCompact: last_type = "mark_sweep_compact"; break;
+	default: break;
+	}
+
+	v8::Local<v8::Object> result = v8::Object::New(isolate);
+	set_option(isolate, result, "scavenge_count", value.scavenge_count);
+	set_option(isolate, result, "mark_sweep_count", value.mark_sweep_count);
+	set_option(isolate, result, "pause", value.pause);
+	set_option(isolate, result, "reclaimed", value.reclaimed);
+	set_option(isolate, result, "last_pause", value.last_pause);
+	set_option(isolate, result, "last_type", last_type);
+	return scope.Escape(result);
+}
+
+} // namespace v8pp
@@ -0,0 +1,135 @@
+#ifndef V8PP_HEAP_STATS_HPP_INCLUDED
+#define V8PP_HEAP_STATS_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+#include "v8pp/module.hpp"
+
+namespace v8pp {
+
+/// V8 heap statistics snapshot, in bytes
+struct heap_stats
+{
+	size_t total_heap_size;
+	size_t total_heap_size_executable;
+	size_t total_physical_size;
+	size_t used_heap_size;
+	size_t heap_size_limit;
+};
+
+/// Histogram of values with power of 2 buckets:
+/// bucket 0 counts zero values, bucket i counts values in [2^(i-1), 2^i)
+struct histogram
+{
+	static size_t const bucket_count = 40;
+
+	uint64_t count;
+	uint64_t sum;
+	uint64_t max;
+	uint64_t buckets[bucket_count];
+
+	histogram() { reset(); }
+
+	void reset();
+	void add(uint64_t value);
+};
+
+/// Garbage collection statistics
+struct gc_stats
+{
+	/// Number of scavenges (minor GC)
+	uint64_t scavenge_count;
+	/// Number of mark-sweep-compacts (major GC)
+	uint64_t mark_sweep_count;
+	/// GC pause durations, in microseconds
+	histogram pause;
+	/// Heap bytes reclaimed by a GC
+	histogram reclaimed;
+	/// Last GC pause duration, in microseconds
+	uint64_t last_pause;
+	/// Last GC type
+	v8::GCType last_type;
+
+	gc_stats() { reset(); }
+
+	void reset();
+};
+
+/// Get heap statistics for the isolate
+heap_stats get_heap_stats(v8::Isolate* isolate);
+
+/// Start collecting GC statistics in the isolate, calls are counted
+void enable_gc_stats(v8::Isolate* isolate);
+
+/// Stop collecting GC statistics in the isolate
+void disable_gc_stats(v8::Isolate* isolate);
+
+/// Get GC statistics collected in the isolate
+gc_stats get_gc_stats(v8::Isolate* isolate);
+
+/// Reset GC statistics collected in the isolate
+void reset_gc_stats(v8::Isolate* isolate);
+
+/// Create a module with `heap` and `gc` read-only properties
+/// to access heap and GC statistics from JavaScript.
+/// GC statistics should be enabled in the isolate.
+module stats_module(v8::Isolate* isolate);
+
+template<>
+struct convert<heap_stats>
+{
+	using from_type = heap_stats;
+	using to_type = v8::Handle<v8::Object>;
+
+	static bool is_valid(v8::Isolate*, v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && value->IsObject();
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, heap_stats const& value);
+};
+
+template<>
+struct convert<histogram>
+{
+	using from_type = histogram;
+	using to_type = v8::Handle<v8::Object>;
+
+	static bool is_valid(v8::Isolate*, v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && value->IsObject();
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, histogram const& value);
+};
+
+template<>
+struct convert<gc_stats>
+{
+	using from_type = gc_stats;
+	using to_type = v8::Handle<v8::Object>;
+
+	static bool is_valid(v8::Isolate*, v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && value->IsObject();
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, gc_stats const& value);
+};
+
+template<>
+struct is_wrapped_class<heap_stats> : std::false_type{};
+
+template<>
+struct is_wrapped_class<histogram> : std::false_type{};
+
+template<>
+struct is_wrapped_class<gc_stats> : std::false_type{};
+
+} // namespace v8pp
+
+#endif // V8PP_HEAP_STATS_HPP_INCLUDED
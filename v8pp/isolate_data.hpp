@@ -0,0 +1,116 @@
+#ifndef V8PP_ISOLATE_DATA_HPP_INCLUDED
+#define V8PP_ISOLATE_DATA_HPP_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/config.hpp"
+#include "v8pp/utility.hpp"
+
+namespace v8pp {
+
+namespace detail {
+
+/// Per-isolate instances of v8pp services, stored in V8PP_ISOLATE_STORAGE_SLOT.
+/// A service type T should be constructible from v8::Isolate*.
+/// Services are keyed by type_id<T>() name, so the same instance is found from
+/// the application and from plugins loaded into the isolate.
+/// Service type names should be unique, not in unnamed namespaces.
+class isolate_data
+{
+public:
+	/// Get a service instance for the isolate, creates it on first use
+	template<typename T>
+	static T& get(v8::Isolate* isolate)
+	{
+		if (T* value = find<T>(isolate))
+		{
+			return *value;
+		}
+		// T constructor may create other services, don't hold item references
+		std::unique_ptr<item> ptr(new holder<T>(isolate));
+		isolate_data& data = instance(isolate);
+		data.items_.emplace_back(std::move(ptr));
+		return static_cast<holder<T>&>(*data.items_.back()).value;
+	}
+
+	/// Get an existing service instance for the isolate, may return nullptr
+	template<typename T>
+	static T* find(v8::Isolate* isolate)
+	{
+		isolate_data* data = static_cast<isolate_data*>(isolate->GetData(V8PP_ISOLATE_STORAGE_SLOT));
+		if (data)
+		{
+			type_info const type = type_id<T>();
+			for (std::unique_ptr<item> const& ptr : data->items_)
+			{
+				if (ptr->type == type)
+				{
+					return &static_cast<holder<T>&>(*ptr).value;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	/// Destroy all service instances for the isolate, before its disposal
+	static void release(v8::Isolate* isolate)
+	{
+		isolate_data* data = static_cast<isolate_data*>(isolate->GetData(V8PP_ISOLATE_STORAGE_SLOT));
+		if (data)
+		{
+			// destroy in reverse order of creation
+			while (!data->items_.empty())
+			{
+				std::unique_ptr<item> last = std::move(data->items_.back());
+				data->items_.pop_back();
+			}
+			isolate->SetData(V8PP_ISOLATE_STORAGE_SLOT, nullptr);
+			delete data;
+		}
+	}
+
+private:
+	struct item
+	{
+		type_info const type;
+		explicit item(type_info type) : type(type) {}
+		virtual ~item() {}
+	};
+
+	template<typename T>
+	struct holder : item
+	{
+		T value;
+		explicit holder(v8::Isolate* isolate) : item(type_id<T>()), value(isolate) {}
+	};
+
+	static isolate_data& instance(v8::Isolate* isolate)
+	{
+		isolate_data* data = static_cast<isolate_data*>(isolate->GetData(V8PP_ISOLATE_STORAGE_SLOT));
+		if (!data)
+		{
+			data = new isolate_data;
+			isolate->SetData(V8PP_ISOLATE_STORAGE_SLOT, data);
+		}
+		return *data;
+	}
+
+	std::vector<std::unique_ptr<item>> items_;
+};
+
+} // namespace detail
+
+/// Destroy v8pp per-isolate data, such as deferred finalizer queue and
+/// script cache. Call it before disposal of an isolate created outside of
+/// v8pp::context and v8pp::context_pool, they release data of own isolates.
+inline void release_isolate_data(v8::Isolate* isolate)
+{
+	detail::isolate_data::release(isolate);
+}
+
+} // namespace v8pp
+
+#endif // V8PP_ISOLATE_DATA_HPP_INCLUDED
@@ -0,0 +1,267 @@
+#include "v8pp/isolate_pool.hpp"
+#include "v8pp/convert.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace v8pp {
+
+static void set_thread_affinity(std::thread& thread, isolate_pool::cpu_set const& cpus)
+{
+	if (cpus.empty())
+	{
+		return;
+	}
+#if defined(WIN32)
+	DWORD_PTR mask = 0;
+	for (unsigned cpu : cpus)
+	{
+		mask |= DWORD_PTR(1) << cpu;
+	}
+	::SetThreadAffinityMask(thread.native_handle(), mask);
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (unsigned cpu : cpus)
+	{
+		CPU_SET(cpu, &set);
+	}
+	pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+	(void)thread;
+#endif
+}
+
+static std::string stringify(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+{
+	v8::HandleScope scope(isolate);
+
+	v8::Local<v8::Object> json = isolate->GetCurrentContext()->Global()
+		->Get(to_v8(isolate, "JSON")).As<v8::Object>();
+	v8::Local<v8::Function> stringify = json->Get(to_v8(isolate, "stringify")).As<v8::Function>();
+
+	v8::Handle<v8::Value> args[1] = { value };
+	v8::Local<v8::Value> result = stringify->Call(json, 1, args);
+	// JSON.stringify returns undefined for undefined and functions
+	return result->IsString()? from_v8<std::string>(isolate, result) : std::string();
+}
+
+template<typename Run>
+static std::string run_and_stringify(context& ctx, Run run)
+{
+	v8::Isolate* isolate = ctx.isolate();
+	v8::HandleScope scope(isolate);
+
+	v8::TryCatch try_catch;
+	v8::Local<v8::Value> result = run();
+	std::string json;
+	if (!try_catch.HasCaught())
+	{
+		json = stringify(isolate, result);
+	}
+	if (try_catch.HasCaught())
+	{
+		throw std::runtime_error(from_v8<std::string>(isolate, try_catch.Exception()->ToString()));
+	}
+	return json;
+}
+
+isolate_pool::isolate_pool(size_t workers, init_function init, std::vector<cpu_set> const& affinity)
+	: next_worker_(0)
+	, pending_(0)
+	, idle_gc_(0)
+	, stop_(false)
+{
+	if (workers == 0)
+	{
+		workers = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	workers_.reserve(workers);
+	for (size_t i = 0; i < workers; ++i)
+	{
+		workers_.emplace_back(new worker);
+	}
+
+	std::vector<std::promise<void>> started(workers);
+	for (size_t i = 0; i < workers; ++i)
+	{
+		static cpu_set const no_affinity;
+		cpu_set const& cpus = affinity.empty()? no_affinity : affinity[i % affinity.size()];
+		workers_[i]->thread = std::thread(&isolate_pool::run, this, i, init, std::ref(started[i]));
+		set_thread_affinity(workers_[i]->thread, cpus);
+	}
+
+	std::exception_ptr error;
+	for (std::promise<void>& s : started)
+	{
+		try
+		{
+			s.get_future().get();
+		}
+		catch (...)
+		{
+			if (!error) error = std::current_exception();
+		}
+	}
+	if (error)
+	{
+		stop();
+		std::rethrow_exception(error);
+	}
+}
+
+isolate_pool::~isolate_pool()
+{
+	stop();
+}
+
+void isolate_pool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+
+	for (auto& w : workers_)
+	{
+		if (w->thread.joinable())
+		{
+			w->thread.join();
+		}
+	}
+	workers_.clear();
+}
+
+void isolate_pool::push(job&& j)
+{
+	// count the job before it's visible to workers,
+	// otherwise a worker could decrement pending_ below zero
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++pending_;
+	}
+	size_t const index = next_worker_++ % workers_.size();
+	worker& w = *workers_[index];
+	{
+		std::lock_guard<std::mutex> lock(w.mutex);
+		w.jobs.emplace_back(std::move(j));
+	}
+	cond_.notify_one();
+}
+
+bool isolate_pool::pop(size_t index, job& j)
+{
+	// own queue first, in submission order
+	{
+		worker& w = *workers_[index];
+		std::lock_guard<std::mutex> lock(w.mutex);
+		if (!w.jobs.empty())
+		{
+			j = std::move(w.jobs.front());
+			w.jobs.pop_front();
+			return true;
+		}
+	}
+
+	// steal from the back of other queues
+	for (size_t i = 1, count = workers_.size(); i < count; ++i)
+	{
+		worker& w = *workers_[(index + i) % count];
+		std::unique_lock<std::mutex> lock(w.mutex, std::try_to_lock);
+		if (lock && !w.jobs.empty())
+		{
+			j = std::move(w.jobs.back());
+			w.jobs.pop_back();
+			return true;
+		}
+	}
+	return false;
+}
+
+void isolate_pool::run(size_t index, init_function init, std::promise<void>& started)
+{
+	std::unique_ptr<context> ctx;
+	try
+	{
+		ctx.reset(new context);
+		if (init)
+		{
+			v8::HandleScope scope(ctx->isolate());
+			init(*ctx);
+		}
+		started.set_value();
+	}
+	catch (...)
+	{
+		started.set_exception(std::current_exception());
+		return;
+	}
+
+	bool gc_pending = false;
+	for (;;)
+	{
+		job j;
+		if (pop(index, j))
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				--pending_;
+			}
+			v8::HandleScope scope(ctx->isolate());
+			j(*ctx);
+			gc_pending = true;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (pending_ == 0)
+		{
+			if (stop_)
+			{
+				break;
+			}
+			std::chrono::milliseconds const idle_time(idle_gc_);
+			if (gc_pending && idle_time.count())
+			{
+				// GC work between jobs, in slices to pick up new jobs soon
+				lock.unlock();
+				gc_pending = !ctx->idle(idle_time);
+				continue;
+			}
+			cond_.wait(lock);
+		}
+		else
+		{
+			// pending jobs are being popped by other workers,
+			// or their queues are locked for stealing: retry later
+			cond_.wait_for(lock, std::chrono::milliseconds(1));
+		}
+	}
+}
+
+std::future<std::string> isolate_pool::run_script(std::string const& source, std::string const& filename)
+{
+	return submit([source, filename](context& ctx)
+		{
+			return run_and_stringify(ctx, [&]() { return ctx.run_script(source, filename); });
+		});
+}
+
+std::future<std::string> isolate_pool::run_file(std::string const& filename)
+{
+	return submit([filename](context& ctx)
+		{
+			return run_and_stringify(ctx, [&]() { return ctx.run_file(filename); });
+		});
+}
+
+} // namespace v8pp
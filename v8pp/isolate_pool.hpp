@@ -0,0 +1,111 @@
+#ifndef V8PP_ISOLATE_POOL_HPP_INCLUDED
+#define V8PP_ISOLATE_POOL_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "v8pp/context.hpp"
+
+namespace v8pp {
+
+/// Pool of worker threads, each one owns a V8 isolate with a context.
+/// Jobs are distributed over per-worker queues, an idle worker steals
+/// jobs from queues of other workers. Job results are returned as
+/// std::future values, so they should be C++ values, not V8 handles.
+/// V8 must be initialized before the pool creation.
+class isolate_pool
+{
+public:
+	/// Context initialization function, invoked in each worker thread
+	using init_function = std::function<void (context& ctx)>;
+
+	/// Set of CPU numbers a worker thread may run on
+	using cpu_set = std::vector<unsigned>;
+
+	/// Create a pool with `workers` threads, 0 means hardware concurrency.
+	/// Each worker context is initialized with `init` function.
+	/// Optional `affinity` pins the worker `i` to `affinity[i % affinity.size()]`
+	/// CPU set, use CPUs of a NUMA node as the set to pin workers to the node.
+	/// Rethrows the first initialization error.
+	explicit isolate_pool(size_t workers, init_function init = init_function(),
+		std::vector<cpu_set> const& affinity = std::vector<cpu_set>());
+
+	/// Finish remaining jobs and stop the workers
+	~isolate_pool();
+
+	isolate_pool(isolate_pool const&) = delete;
+	isolate_pool& operator=(isolate_pool const&) = delete;
+
+	/// Number of worker threads
+	size_t size() const { return workers_.size(); }
+
+	/// Number of jobs waiting in the queues
+	size_t pending() const { return pending_; }
+
+	/// Idle time slice for GC work in a worker without jobs, 0 disables idle GC.
+	/// An idle worker repeats the slices until V8 has no more GC work to do,
+	/// a new job waits for the current slice. See context::idle()
+	std::chrono::milliseconds idle_gc() const { return std::chrono::milliseconds(idle_gc_); }
+	void set_idle_gc(std::chrono::milliseconds idle_time) { idle_gc_ = idle_time.count(); }
+
+	/// Submit a job `R f(context&)` to run in a worker thread
+	template<typename F>
+	std::future<typename std::result_of<F(context&)>::type> submit(F&& f)
+	{
+		using result_type = typename std::result_of<F(context&)>::type;
+		using task_type = std::packaged_task<result_type (context&)>;
+
+		auto task = std::make_shared<task_type>(std::forward<F>(f));
+		std::future<result_type> result = task->get_future();
+		push([task](context& ctx) { (*task)(ctx); });
+		return result;
+	}
+
+	/// Run script source in a worker thread, returns the script result
+	/// serialized with JSON.stringify. Script exceptions are rethrown
+	/// as std::runtime_error from the future.
+	/// JSON is used to get a result readable without an isolate, use
+	/// submit() with v8pp::serialize() to copy the result into another isolate.
+	std::future<std::string> run_script(std::string const& source, std::string const& filename = "");
+
+	/// Run script file in a worker thread, see run_script
+	std::future<std::string> run_file(std::string const& filename);
+
+private:
+	using job = std::function<void (context& ctx)>;
+
+	struct worker
+	{
+		std::thread thread;
+		std::mutex mutex;
+		std::deque<job> jobs;
+	};
+
+	void push(job&& j);
+	bool pop(size_t index, job& j);
+	void run(size_t index, init_function init, std::promise<void>& started);
+	void stop();
+
+	std::vector<std::unique_ptr<worker>> workers_;
+	std::atomic<size_t> next_worker_;
+	std::atomic<size_t> pending_;
+	std::atomic<std::chrono::milliseconds::rep> idle_gc_;
+
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	bool stop_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_ISOLATE_POOL_HPP_INCLUDED
@@ -0,0 +1,421 @@
+#include "v8pp/json.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace v8pp { namespace detail {
+
+void json_write_null(std::string& out)
+{
+	out.append("null", 4);
+}
+
+void json_write_bool(std::string& out, bool value)
+{
+	if (value) out.append("true", 4); else out.append("false", 5);
+}
+
+void json_write_number(std::string& out, double value)
+{
+	if (!std::isfinite(value))
+	{
+		json_write_null(out);
+	}
+	else if (value == std::floor(value) && std::fabs(value) < 1e15)
+	{
+		json_write_integer(out, static_cast<long long>(value));
+	}
+	else
+	{
+		// shortest of 15 or 17 significant digits to read the same value back
+		char buf[32];
+		int len = std::snprintf(buf, sizeof(buf), "%.15g", value);
+		if (std::strtod(buf, nullptr) != value)
+		{
+			len = std::snprintf(buf, sizeof(buf), "%.17g", value);
+		}
+		out.append(buf, len);
+	}
+}
+
+void json_write_integer(std::string& out, long long value)
+{
+	if (value < 0)
+	{
+		out += '-';
+		// negate in unsigned to handle the minimal value
+		json_write_unsigned(out, 0ull - static_cast<unsigned long long>(value));
+	}
+	else
+	{
+		json_write_unsigned(out, static_cast<unsigned long long>(value));
+	}
+}
+
+void json_write_unsigned(std::string& out, unsigned long long value)
+{
+	char buf[24];
+	char* end = buf + sizeof(buf);
+	char* ptr = end;
+	do
+	{
+		*--ptr = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value);
+	out.append(ptr, end);
+}
+
+void json_write_string(std::string& out, char const* str, size_t len)
+{
+	static char const hex[] = "0123456789abcdef";
+
+	out += '"';
+	char const* const end = str + len;
+	char const* run = str;
+	for (char const* ptr = str; ptr != end; ++ptr)
+	{
+		unsigned char const c = static_cast<unsigned char>(*ptr);
+		if (c >= 0x20 && c != '"' && c != '\\')
+		{
+			continue;
+		}
+		out.append(run, ptr);
+		run = ptr + 1;
+		switch (c)
+		{
+		case '"':  out.append("\\\"", 2); break;
+		case '\\': out.append("\\\\", 2); break;
+		case '\n': out.append("\\n", 2); break;
+		case '\r': out.append("\\r", 2); break;
+		case '\t': out.append("\\t", 2); break;
+		default:
+			out.append("\\u00", 4);
+			out += hex[c >> 4];
+			out += hex[c & 0x0F];
+			break;
+		}
+	}
+	out.append(run, end);
+	out += '"';
+}
+
+void json_reader::error(char const* what) const
+{
+	throw std::invalid_argument(std::string("JSON ") + what
+		+ " at offset " + std::to_string(pos_ - begin_));
+}
+
+char json_reader::peek()
+{
+	while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r'))
+	{
+		++pos_;
+	}
+	return pos_ != end_? *pos_ : '\0';
+}
+
+void json_reader::expect(char c)
+{
+	if (peek() != c)
+	{
+		std::string const what = std::string("expected ") + c;
+		error(what.c_str());
+	}
+	++pos_;
+}
+
+static bool skip_literal(char const*& pos, char const* end, char const* literal, size_t len)
+{
+	if (static_cast<size_t>(end - pos) < len || std::char_traits<char>::compare(pos, literal, len) != 0)
+	{
+		return false;
+	}
+	pos += len;
+	return true;
+}
+
+bool json_reader::read_null()
+{
+	return peek() == 'n' && skip_literal(pos_, end_, "null", 4);
+}
+
+bool json_reader::read_bool()
+{
+	char const c = peek();
+	if (c == 't' && skip_literal(pos_, end_, "true", 4)) return true;
+	if (c == 'f' && skip_literal(pos_, end_, "false", 5)) return false;
+	error("expected boolean");
+}
+
+double json_reader::read_number()
+{
+	peek();
+	char const* const start = pos_;
+	bool const negative = (pos_ != end_ && *pos_ == '-');
+	if (negative) ++pos_;
+
+	// integers up to 15 digits are exact without strtod,
+	// longer ones are not accumulated to avoid overflow
+	long long integer = 0;
+	int digits = 0;
+	while (pos_ != end_ && *pos_ >= '0' && *pos_ <= '9')
+	{
+		if (digits < 15)
+		{
+			integer = integer * 10 + (*pos_ - '0');
+		}
+		++digits;
+		++pos_;
+	}
+	if (digits == 0)
+	{
+		pos_ = start;
+		error("expected number");
+	}
+	bool const fraction = pos_ != end_ && (*pos_ == '.' || *pos_ == 'e' || *pos_ == 'E');
+	if (!fraction && digits <= 15)
+	{
+		return static_cast<double>(negative? -integer : integer);
+	}
+
+	while (pos_ != end_ && ((*pos_ >= '0' && *pos_ <= '9')
+		|| *pos_ == '.' || *pos_ == 'e' || *pos_ == 'E' || *pos_ == '+' || *pos_ == '-'))
+	{
+		++pos_;
+	}
+	std::string const text(start, pos_);
+	char* text_end;
+	double const result = std::strtod(text.c_str(), &text_end);
+	if (text_end != text.c_str() + text.size())
+	{
+		pos_ = start;
+		error("invalid number");
+	}
+	return result;
+}
+
+static void append_utf8(std::string& str, unsigned long code)
+{
+	if (code < 0x80)
+	{
+		str += static_cast<char>(code);
+	}
+	else if (code < 0x800)
+	{
+		str += static_cast<char>(0xC0 | (code >> 6));
+		str += static_cast<char>(0x80 | (code & 0x3F));
+	}
+	else if (code < 0x10000)
+	{
+		str += static_cast<char>(0xE0 | (code >> 12));
+		str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		str += static_cast<char>(0x80 | (code & 0x3F));
+	}
+	else
+	{
+		str += static_cast<char>(0xF0 | (code >> 18));
+		str += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+		str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		str += static_cast<char>(0x80 | (code & 0x3F));
+	}
+}
+
+void json_reader::read_string(std::string& str)
+{
+	expect('"');
+	str.clear();
+
+	char const* run = pos_;
+	for (;;)
+	{
+		if (pos_ == end_)
+		{
+			error("unterminated string");
+		}
+		char const c = *pos_;
+		if (c == '"')
+		{
+			str.append(run, pos_);
+			++pos_;
+			return;
+		}
+		if (c != '\\')
+		{
+			++pos_;
+			continue;
+		}
+
+		str.append(run, pos_);
+		if (++pos_ == end_)
+		{
+			error("unterminated string");
+		}
+		switch (*pos_++)
+		{
+		case '"':  str += '"'; break;
+		case '\\': str += '\\'; break;
+		case '/':  str += '/'; break;
+		case 'b':  str += '\b'; break;
+		case 'f':  str += '\f'; break;
+		case 'n':  str += '\n'; break;
+		case 'r':  str += '\r'; break;
+		case 't':  str += '\t'; break;
+		case 'u':
+			{
+				unsigned long code = read_hex4();
+				if (code >= 0xD800 && code < 0xDC00 && end_ - pos_ >= 6 && pos_[0] == '\\' && pos_[1] == 'u')
+				{
+					char const* const high_end = pos_;
+					pos_ += 2;
+					unsigned long const low = read_hex4();
+					if (low >= 0xDC00 && low < 0xE000)
+					{
+						code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+					}
+					else
+					{
+						pos_ = high_end;
+					}
+				}
+				append_utf8(str, code);
+			}
+			break;
+		default:
+			--pos_;
+			error("invalid escape");
+		}
+		run = pos_;
+	}
+}
+
+unsigned long json_reader::read_hex4()
+{
+	if (end_ - pos_ < 4)
+	{
+		error("invalid unicode escape");
+	}
+	unsigned long code = 0;
+	for (int i = 0; i < 4; ++i, ++pos_)
+	{
+		char const c = *pos_;
+		code <<= 4;
+		if (c >= '0' && c <= '9') code |= c - '0';
+		else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+		else error("invalid unicode escape");
+	}
+	return code;
+}
+
+void json_reader::begin_array()
+{
+	expect('[');
+}
+
+void json_reader::begin_object()
+{
+	expect('{');
+}
+
+bool json_reader::next_item(char close, bool first)
+{
+	if (peek() == close)
+	{
+		++pos_;
+		return false;
+	}
+	if (!first)
+	{
+		expect(',');
+	}
+	return true;
+}
+
+void json_reader::read_colon()
+{
+	expect(':');
+}
+
+void json_reader::finish()
+{
+	if (peek() != '\0')
+	{
+		error("unexpected text after value");
+	}
+}
+
+static size_t saturated_product(size_t length, size_t inner)
+{
+	return inner && length > std::numeric_limits<size_t>::max() / inner?
+		std::numeric_limits<size_t>::max() : length * inner;
+}
+
+size_t bulk_size(v8::Isolate* isolate, v8::Handle<v8::Value> value, size_t depth)
+{
+	if (value.IsEmpty())
+	{
+		return 0;
+	}
+	if (depth == 0)
+	{
+		return 1;
+	}
+
+	v8::HandleScope scope(isolate);
+
+	if (value->IsArray())
+	{
+		v8::Local<v8::Array> array = value.As<v8::Array>();
+		uint32_t const length = array->Length();
+		return length? saturated_product(length, bulk_size(isolate, array->Get(0), depth - 1)) : 0;
+	}
+	if (value->IsObject() && !value->IsFunction() && !value->IsArrayBufferView())
+	{
+		v8::Local<v8::Object> obj = value.As<v8::Object>();
+		v8::Local<v8::Array> names = obj->GetOwnPropertyNames();
+		uint32_t const length = names->Length();
+		return length? saturated_product(length, bulk_size(isolate, obj->Get(names->Get(0)), depth - 1)) : 0;
+	}
+	return 1;
+}
+
+v8::Local<v8::Value> json_parse(v8::Isolate* isolate, std::string const& json)
+{
+	v8::EscapableHandleScope scope(isolate);
+
+	v8::Local<v8::String> str = v8::String::NewFromUtf8(isolate, json.data(),
+		v8::String::kNormalString, static_cast<int>(json.size()));
+	v8::TryCatch try_catch;
+	v8::Local<v8::Value> result = v8::JSON::Parse(str);
+	if (try_catch.HasCaught() || result.IsEmpty())
+	{
+		throw std::runtime_error("JSON.parse failed");
+	}
+	return scope.Escape(result);
+}
+
+std::string json_stringify(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+{
+	v8::HandleScope scope(isolate);
+
+	v8::Local<v8::Object> json = isolate->GetCurrentContext()->Global()
+		->Get(to_v8(isolate, "JSON")).As<v8::Object>();
+	v8::Local<v8::Function> stringify = json->Get(to_v8(isolate, "stringify")).As<v8::Function>();
+
+	v8::Handle<v8::Value> args[1] = { value };
+	v8::TryCatch try_catch;
+	v8::Local<v8::Value> result = stringify->Call(json, 1, args);
+	if (try_catch.HasCaught() || result.IsEmpty())
+	{
+		throw std::runtime_error("JSON.stringify failed");
+	}
+	// JSON.stringify returns undefined for undefined and functions
+	if (!result->IsString())
+	{
+		throw std::invalid_argument("value is not JSON serializable");
+	}
+	return from_v8<std::string>(isolate, result);
+}
+
+}} // namespace v8pp::detail
@@ -0,0 +1,316 @@
+#ifndef V8PP_JSON_HPP_INCLUDED
+#define V8PP_JSON_HPP_INCLUDED
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+
+namespace v8pp {
+
+/// Conversion mode of large C++ containers
+enum class bulk_mode
+{
+	never,     ///< convert each element with convert<T>
+	always,    ///< convert via JSON string in a single engine call
+	automatic, ///< convert via JSON when the container has at least threshold elements
+};
+
+struct bulk_options
+{
+	bulk_mode mode = bulk_mode::automatic;
+
+	/// Minimum estimated number of container elements to use JSON in automatic mode.
+	/// Measure the crossover for your data with `v8pp_test --run-benchmarks`
+	size_t threshold = 256;
+};
+
+namespace detail {
+
+// JSON text writer
+void json_write_null(std::string& out);
+void json_write_bool(std::string& out, bool value);
+void json_write_number(std::string& out, double value);
+void json_write_integer(std::string& out, long long value);
+void json_write_unsigned(std::string& out, unsigned long long value);
+void json_write_string(std::string& out, char const* str, size_t len);
+
+// JSON text reader, throws std::invalid_argument on syntax error
+class json_reader
+{
+public:
+	json_reader(char const* begin, char const* end)
+		: begin_(begin)
+		, pos_(begin)
+		, end_(end)
+	{
+	}
+
+	bool read_null();
+	bool read_bool();
+	double read_number();
+	void read_string(std::string& str);
+
+	void begin_array();
+	void begin_object();
+
+	/// Is there the next item in array or object, skip separator before it
+	bool next_item(char close, bool first);
+
+	/// Skip colon after object key
+	void read_colon();
+
+	/// Check there is no more text
+	void finish();
+
+private:
+	[[noreturn]] void error(char const* what) const;
+	char peek();
+	void expect(char c);
+	unsigned long read_hex4();
+
+	char const* begin_;
+	char const* pos_;
+	char const* end_;
+};
+
+// Container overloads declared before definitions to find each other when nested
+template<typename T, typename Alloc>
+size_t bulk_size(std::vector<T, Alloc> const& value);
+template<typename Key, typename T, typename Less, typename Alloc>
+size_t bulk_size(std::map<Key, T, Less, Alloc> const& value);
+
+template<typename T, typename Alloc>
+void json_encode(std::string& out, std::vector<T, Alloc> const& value);
+template<typename T, typename Less, typename Alloc>
+void json_encode(std::string& out, std::map<std::string, T, Less, Alloc> const& value);
+
+template<typename T, typename Alloc>
+void json_decode(json_reader& reader, std::vector<T, Alloc>& value);
+template<typename T, typename Less, typename Alloc>
+void json_decode(json_reader& reader, std::map<std::string, T, Less, Alloc>& value);
+
+// Estimated number of elements in regular nested containers,
+// using the first element size of each nesting level
+template<typename T>
+size_t bulk_size(T const&)
+{
+	return 1;
+}
+
+template<typename T, typename Alloc>
+size_t bulk_size(std::vector<T, Alloc> const& value)
+{
+	return value.empty()? 0 : value.size() * bulk_size(value.front());
+}
+
+template<typename Key, typename T, typename Less, typename Alloc>
+size_t bulk_size(std::map<Key, T, Less, Alloc> const& value)
+{
+	return value.empty()? 0 : value.size() * bulk_size(value.begin()->second);
+}
+
+// Container nesting depth of C++ type
+template<typename T>
+struct bulk_depth : std::integral_constant<size_t, 0> {};
+
+template<typename T, typename Alloc>
+struct bulk_depth<std::vector<T, Alloc>> : std::integral_constant<size_t, 1 + bulk_depth<T>::value> {};
+
+template<typename Key, typename T, typename Less, typename Alloc>
+struct bulk_depth<std::map<Key, T, Less, Alloc>> : std::integral_constant<size_t, 1 + bulk_depth<T>::value> {};
+
+// Estimated number of elements in V8 arrays and objects up to depth levels,
+// bounded for cyclic values such as `a[0] = a`
+size_t bulk_size(v8::Isolate* isolate, v8::Handle<v8::Value> value, size_t depth);
+
+// JSON encoding of supported C++ types
+inline void json_encode(std::string& out, bool value)
+{
+	json_write_bool(out, value);
+}
+
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type
+json_encode(std::string& out, T value)
+{
+	json_write_number(out, value);
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+json_encode(std::string& out, T value)
+{
+	json_write_integer(out, value);
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+json_encode(std::string& out, T value)
+{
+	json_write_unsigned(out, value);
+}
+
+inline void json_encode(std::string& out, std::string const& value)
+{
+	json_write_string(out, value.data(), value.size());
+}
+
+inline void json_encode(std::string& out, char const* value)
+{
+	json_write_string(out, value, std::char_traits<char>::length(value));
+}
+
+template<typename T, typename Alloc>
+void json_encode(std::string& out, std::vector<T, Alloc> const& value)
+{
+	out += '[';
+	for (size_t i = 0; i < value.size(); ++i)
+	{
+		if (i) out += ',';
+		json_encode(out, value[i]);
+	}
+	out += ']';
+}
+
+template<typename T, typename Less, typename Alloc>
+void json_encode(std::string& out, std::map<std::string, T, Less, Alloc> const& value)
+{
+	out += '{';
+	bool first = true;
+	for (auto const& item : value)
+	{
+		if (!first) out += ',';
+		first = false;
+		json_encode(out, item.first);
+		out += ':';
+		json_encode(out, item.second);
+	}
+	out += '}';
+}
+
+// JSON decoding of supported C++ types
+inline void json_decode(json_reader& reader, bool& value)
+{
+	value = reader.read_bool();
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type
+json_decode(json_reader& reader, T& value)
+{
+	// JSON.stringify writes NaN and infinities as null
+	if (std::numeric_limits<T>::has_quiet_NaN && reader.read_null())
+	{
+		value = std::numeric_limits<T>::quiet_NaN();
+	}
+	else
+	{
+		value = static_cast<T>(reader.read_number());
+	}
+}
+
+inline void json_decode(json_reader& reader, std::string& value)
+{
+	reader.read_string(value);
+}
+
+template<typename T, typename Alloc>
+void json_decode(json_reader& reader, std::vector<T, Alloc>& value)
+{
+	value.clear();
+	reader.begin_array();
+	for (bool first = true; reader.next_item(']', first); first = false)
+	{
+		value.emplace_back();
+		json_decode(reader, value.back());
+	}
+}
+
+template<typename T, typename Less, typename Alloc>
+void json_decode(json_reader& reader, std::map<std::string, T, Less, Alloc>& value)
+{
+	value.clear();
+	reader.begin_object();
+	std::string key;
+	for (bool first = true; reader.next_item('}', first); first = false)
+	{
+		reader.read_string(key);
+		reader.read_colon();
+		json_decode(reader, value[key]);
+	}
+}
+
+v8::Local<v8::Value> json_parse(v8::Isolate* isolate, std::string const& json);
+std::string json_stringify(v8::Isolate* isolate, v8::Handle<v8::Value> value);
+
+} // namespace detail
+
+/// JSON text of C++ value: a number, bool, string, or nested
+/// std::vector and std::map with string keys of them
+template<typename T>
+std::string to_json(T const& value)
+{
+	std::string result;
+	detail::json_encode(result, value);
+	return result;
+}
+
+/// C++ value from JSON text, see to_json().
+/// Throws std::invalid_argument on invalid JSON or type mismatch
+template<typename T>
+T from_json(std::string const& json)
+{
+	T result;
+	detail::json_reader reader(json.data(), json.data() + json.size());
+	detail::json_decode(reader, result);
+	reader.finish();
+	return result;
+}
+
+/// Convert C++ value to V8, creating large containers with a single JSON.parse call
+/// instead of setting each element, see bulk_options.
+/// JSON has no NaN and infinities, they are converted to null in JSON mode
+template<typename T>
+v8::Local<v8::Value> to_v8_bulk(v8::Isolate* isolate, T const& value,
+	bulk_options const& options = bulk_options())
+{
+	bool const use_json = options.mode == bulk_mode::always
+		|| (options.mode == bulk_mode::automatic && detail::bulk_size(value) >= options.threshold);
+	if (!use_json)
+	{
+		v8::EscapableHandleScope scope(isolate);
+		return scope.Escape(v8::Local<v8::Value>(to_v8(isolate, value)));
+	}
+	return detail::json_parse(isolate, to_json(value));
+}
+
+/// Convert V8 value to C++, reading large containers from a single JSON.stringify
+/// call instead of getting each element, see bulk_options.
+/// JSON mode has JSON.stringify semantics: toJSON() methods are called, undefined
+/// and function values are omitted in objects and become null in arrays, read as NaN
+/// for numbers. Element conversion may throw or produce other values for them,
+/// both modes give the same result for plain data only.
+template<typename T>
+T from_v8_bulk(v8::Isolate* isolate, v8::Handle<v8::Value> value,
+	bulk_options const& options = bulk_options())
+{
+	bool const use_json = options.mode == bulk_mode::always
+		|| (options.mode == bulk_mode::automatic && detail::bulk_size(isolate, value, detail::bulk_depth<T>::value) >= options.threshold);
+	if (!use_json)
+	{
+		return from_v8<T>(isolate, value);
+	}
+	return from_json<T>(detail::json_stringify(isolate, value));
+}
+
+} // namespace v8pp
+
+#endif // V8PP_JSON_HPP_INCLUDED
@@ -124,6 +124,21 @@ public:
 		return set(name, m.new_instance());
 	}
 
+	/// Set a lazily created value in the module with specified name.
+	/// The initializer is called on the first property access in each module
+	/// instance as `initializer(isolate)` and should return a V8 value,
+	/// such as a class function or a submodule instance.
+	/// The property is replaced with the returned value.
+	template<typename Initializer>
+	module& set_lazy(char const* name, Initializer initializer)
+	{
+		v8::HandleScope scope(isolate_);
+
+		v8::Handle<v8::Value> data = detail::set_external_data(isolate_, initializer);
+		obj_->SetAccessor(v8pp::to_v8(isolate_, name), &lazy_get<Initializer>, nullptr, data);
+		return *this;
+	}
+
 	/// Create a new module instance in V8
 	v8::Local<v8::Object> new_instance() { return obj_->NewInstance(); }
 
@@ -137,6 +152,26 @@ private:
 		info.GetReturnValue().Set(to_v8(isolate, *var));
 	}
 
+	template<typename Initializer>
+	static void lazy_get(v8::Local<v8::String> name, v8::PropertyCallbackInfo<v8::Value> const& info)
+	{
+		v8::Isolate* isolate = info.GetIsolate();
+		try
+		{
+			auto&& initializer = detail::get_external_data<Initializer>(info.Data());
+			v8::Handle<v8::Value> value = initializer(isolate);
+
+			// replace the accessor with a data property
+			info.Holder()->ForceDelete(name);
+			info.Holder()->ForceSet(name, value, v8::DontDelete);
+			info.GetReturnValue().Set(value);
+		}
+		catch (std::exception const& ex)
+		{
+			info.GetReturnValue().Set(throw_ex(isolate, ex.what()));
+		}
+	}
+
 	template<typename Variable>
 	static void var_set(v8::Local<v8::String>, v8::Local<v8::Value> value, v8::PropertyCallbackInfo<void> const& info)
 	{
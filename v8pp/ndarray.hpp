@@ -0,0 +1,467 @@
+#ifndef V8PP_NDARRAY_HPP_INCLUDED
+#define V8PP_NDARRAY_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/bytes.hpp"
+#include "v8pp/convert.hpp"
+#include "v8pp/typed_array.hpp"
+
+namespace v8pp {
+
+/// Memory order of contiguous N-dimensional array elements
+enum class array_order
+{
+	row_major,    ///< last index varies fastest, as in C
+	column_major, ///< first index varies fastest, as in Fortran
+};
+
+/// N-dimensional array of arithmetic type T: data with shape and strides,
+/// counted in elements. It either owns contiguous storage or views
+/// external memory, such as a matrix of a numerical library.
+///
+/// Converted to V8 as an object `{ data, shape, strides }` where `data`
+/// is a typed_array<T>, and element (i, j, ...) is at index
+/// `i * strides[0] + j * strides[1] + ...`, so any size of array
+/// costs a constant number of V8 handles:
+///   * moved owning array gives its storage to the ArrayBuffer without copying
+///   * view of external memory is converted without copying, the memory
+///     must outlive the V8 value
+///   * owning array passed by const reference is copied
+///
+/// Converted from V8 to a view of the typed array memory, valid while
+/// the typed array is alive. Strides are optional in the V8 object,
+/// without them `order: 'F'` means column-major data, otherwise it is row-major.
+template<typename T>
+class ndarray
+{
+public:
+	using value_type = T;
+	using shape_type = std::vector<size_t>;
+
+	ndarray() : data_(nullptr) {}
+
+	/// Owning zero-filled array of shape
+	explicit ndarray(shape_type shape, array_order order = array_order::row_major)
+		: shape_(std::move(shape))
+		, strides_(contiguous_strides(shape_, order))
+		, storage_(element_count(shape_))
+		, data_(storage_.data())
+	{
+	}
+
+	/// Owning array of shape with contiguous data in order
+	ndarray(shape_type shape, std::vector<T> data, array_order order = array_order::row_major)
+		: shape_(std::move(shape))
+		, strides_(contiguous_strides(shape_, order))
+		, storage_(std::move(data))
+		, data_(storage_.data())
+	{
+		if (storage_.size() != element_count(shape_))
+		{
+			throw std::invalid_argument("ndarray data size doesn't match shape");
+		}
+	}
+
+	/// Non-owning view of contiguous data in order
+	static ndarray view(T* data, shape_type shape, array_order order = array_order::row_major)
+	{
+		shape_type strides = contiguous_strides(shape, order);
+		return ndarray(data, std::move(shape), std::move(strides));
+	}
+
+	/// Non-owning view of data with strides in elements
+	static ndarray view(T* data, shape_type shape, shape_type strides)
+	{
+		if (strides.size() != shape.size())
+		{
+			throw std::invalid_argument("ndarray strides don't match shape");
+		}
+		return ndarray(data, std::move(shape), std::move(strides));
+	}
+
+	ndarray(ndarray const& src)
+		: shape_(src.shape_)
+		, strides_(src.strides_)
+		, storage_(src.storage_)
+		, data_(src.owns_data()? storage_.data() + (src.data_ - src.storage_.data()) : src.data_)
+	{
+	}
+
+	ndarray& operator=(ndarray const& src)
+	{
+		if (&src != this)
+		{
+			ndarray copy(src);
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	// vector move keeps its storage, so data_ stays valid,
+	// the source is left empty as a default constructed array
+	ndarray(ndarray&& src)
+		: shape_(std::move(src.shape_))
+		, strides_(std::move(src.strides_))
+		, storage_(std::move(src.storage_))
+		, data_(src.data_)
+	{
+		src.reset();
+	}
+
+	ndarray& operator=(ndarray&& src)
+	{
+		if (&src != this)
+		{
+			shape_ = std::move(src.shape_);
+			strides_ = std::move(src.strides_);
+			storage_ = std::move(src.storage_);
+			data_ = src.data_;
+			src.reset();
+		}
+		return *this;
+	}
+
+	/// Pointer to the first element
+	T* data() const { return data_; }
+
+	/// Array dimensions
+	shape_type const& shape() const { return shape_; }
+
+	/// Distance between adjacent elements in each dimension, in elements
+	shape_type const& strides() const { return strides_; }
+
+	/// Number of dimensions
+	size_t ndim() const { return shape_.size(); }
+
+	/// Number of elements
+	size_t size() const { return element_count(shape_); }
+
+	/// Number of elements from data() to the last element, inclusive
+	size_t span() const
+	{
+		if (size() == 0)
+		{
+			return 0;
+		}
+		size_t result = 1;
+		for (size_t i = 0; i < shape_.size(); ++i)
+		{
+			result += (shape_[i] - 1) * strides_[i];
+		}
+		return result;
+	}
+
+	/// Is the array owning its storage
+	bool owns_data() const { return !storage_.empty(); }
+
+	/// Are the elements contiguous in order
+	bool is_contiguous(array_order order = array_order::row_major) const
+	{
+		return strides_ == contiguous_strides(shape_, order);
+	}
+
+	/// Element at index with the number of dimensions,
+	/// throws std::out_of_range for invalid index
+	T& at(std::initializer_list<size_t> index)
+	{
+		return data_[offset(index)];
+	}
+
+	T const& at(std::initializer_list<size_t> index) const
+	{
+		return data_[offset(index)];
+	}
+
+	/// Move owning array storage out, leaving the array empty.
+	/// Sets `offset` to index of data() in the storage.
+	std::vector<T> release(size_t& offset)
+	{
+		offset = owns_data()? data_ - storage_.data() : 0;
+		std::vector<T> result;
+		result.swap(storage_);
+		reset();
+		return result;
+	}
+
+	/// Strides of contiguous array with shape in order
+	static shape_type contiguous_strides(shape_type const& shape, array_order order)
+	{
+		shape_type strides(shape.size());
+		size_t stride = 1;
+		if (order == array_order::row_major)
+		{
+			for (size_t i = shape.size(); i-- > 0; )
+			{
+				strides[i] = stride;
+				stride *= shape[i];
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < shape.size(); ++i)
+			{
+				strides[i] = stride;
+				stride *= shape[i];
+			}
+		}
+		return strides;
+	}
+
+private:
+	ndarray(T* data, shape_type shape, shape_type strides)
+		: shape_(std::move(shape))
+		, strides_(std::move(strides))
+		, data_(data)
+	{
+	}
+
+	size_t offset(std::initializer_list<size_t> index) const
+	{
+		if (index.size() != shape_.size())
+		{
+			throw std::out_of_range("ndarray index dimensions mismatch");
+		}
+		size_t result = 0, dim = 0;
+		for (size_t i : index)
+		{
+			if (i >= shape_[dim])
+			{
+				throw std::out_of_range("ndarray index out of range");
+			}
+			result += i * strides_[dim];
+			++dim;
+		}
+		return result;
+	}
+
+	void reset()
+	{
+		shape_.clear();
+		strides_.clear();
+		storage_.clear();
+		data_ = nullptr;
+	}
+
+	static size_t element_count(shape_type const& shape)
+	{
+		size_t result = 1;
+		for (size_t dim : shape)
+		{
+			result *= dim;
+		}
+		return result;
+	}
+
+	shape_type shape_;
+	shape_type strides_;
+	std::vector<T> storage_;
+	T* data_;
+};
+
+namespace detail {
+
+inline v8::Local<v8::Array> dims_to_v8(v8::Isolate* isolate, std::vector<size_t> const& dims)
+{
+	v8::Local<v8::Array> result = v8::Array::New(isolate, static_cast<int>(dims.size()));
+	for (uint32_t i = 0; i < dims.size(); ++i)
+	{
+		result->Set(i, v8::Number::New(isolate, static_cast<double>(dims[i])));
+	}
+	return result;
+}
+
+inline std::vector<size_t> dims_from_v8(v8::Handle<v8::Value> value, char const* name)
+{
+	if (value.IsEmpty() || !value->IsArray())
+	{
+		throw std::invalid_argument(std::string("expected ndarray ") + name + " Array");
+	}
+	v8::Local<v8::Array> array = value.As<v8::Array>();
+	std::vector<size_t> result(array->Length());
+	for (uint32_t i = 0; i < result.size(); ++i)
+	{
+		v8::Local<v8::Value> dim = array->Get(i);
+		if (!dim->IsUint32())
+		{
+			throw std::invalid_argument(std::string("expected non-negative integers in ndarray ") + name);
+		}
+		result[i] = dim->Uint32Value();
+	}
+	return result;
+}
+
+inline size_t checked_mul(size_t a, size_t b)
+{
+	if (b != 0 && a > SIZE_MAX / b)
+	{
+		throw std::invalid_argument("ndarray shape and strides overflow");
+	}
+	return a * b;
+}
+
+inline size_t checked_add(size_t a, size_t b)
+{
+	if (a > SIZE_MAX - b)
+	{
+		throw std::invalid_argument("ndarray shape and strides overflow");
+	}
+	return a + b;
+}
+
+/// Number of elements from the first to the last element of shape and
+/// strides, inclusive, with std::invalid_argument on size_t overflow
+inline size_t checked_span(std::vector<size_t> const& shape, std::vector<size_t> const& strides)
+{
+	size_t count = 1;
+	for (size_t dim : shape)
+	{
+		count = checked_mul(count, dim);
+	}
+	if (count == 0)
+	{
+		return 0;
+	}
+	size_t result = 1;
+	for (size_t i = 0; i < shape.size() && i < strides.size(); ++i)
+	{
+		result = checked_add(result, checked_mul(shape[i] - 1, strides[i]));
+	}
+	return result;
+}
+
+} // namespace detail
+
+template<typename T>
+struct convert<ndarray<T>>
+{
+	using from_type = ndarray<T>;
+	using to_type = v8::Handle<v8::Object>;
+	using typed_array_type = typed_array<T>;
+
+	static bool is_valid(v8::Isolate*, v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && value->IsObject() && !value->IsArrayBufferView();
+	}
+
+	static from_type from_v8(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+	{
+		if (!is_valid(isolate, value))
+		{
+			throw std::invalid_argument("expected ndarray Object");
+		}
+
+		v8::HandleScope scope(isolate);
+		v8::Local<v8::Object> obj = value->ToObject();
+
+		v8::Local<v8::Value> data = obj->Get(v8::String::NewFromUtf8(isolate, "data"));
+		if (!typed_array_type::is_valid(data))
+		{
+			throw std::invalid_argument("expected ndarray data of matching typed array type");
+		}
+		v8::Local<v8::TypedArray> array = data.As<v8::TypedArray>();
+
+		typename from_type::shape_type shape =
+			detail::dims_from_v8(obj->Get(v8::String::NewFromUtf8(isolate, "shape")), "shape");
+
+		v8::Local<v8::Value> strides_value = obj->Get(v8::String::NewFromUtf8(isolate, "strides"));
+		typename from_type::shape_type strides;
+		if (strides_value->IsUndefined())
+		{
+			v8::Local<v8::Value> order = obj->Get(v8::String::NewFromUtf8(isolate, "order"));
+			bool const column_major = !order->IsUndefined()
+				&& convert<std::string>::from_v8(isolate, order) == "F";
+			// check the element count first, contiguous strides don't exceed it
+			detail::checked_span(shape, shape);
+			strides = from_type::contiguous_strides(shape,
+				column_major? array_order::column_major : array_order::row_major);
+		}
+		else
+		{
+			strides = detail::dims_from_v8(strides_value, "strides");
+		}
+
+		uint8_t* bytes = detail::array_buffer_data(array->Buffer());
+		T* ptr = bytes? reinterpret_cast<T*>(bytes + array->ByteOffset()) : nullptr;
+
+		if (detail::checked_span(shape, strides) > array->Length())
+		{
+			throw std::invalid_argument("ndarray shape and strides exceed data length");
+		}
+		return from_type::view(ptr, std::move(shape), std::move(strides));
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, from_type const& value)
+	{
+		v8::EscapableHandleScope scope(isolate);
+
+		size_t const span = value.span();
+		v8::Local<v8::ArrayBuffer> buffer;
+		if (value.owns_data())
+		{
+			buffer = detail::new_array_buffer(isolate, value.data(), span * sizeof(T));
+		}
+		else if (span)
+		{
+			// external memory, not freed by V8
+			buffer = v8::ArrayBuffer::New(isolate, value.data(), span * sizeof(T));
+		}
+		else
+		{
+			buffer = v8::ArrayBuffer::New(isolate, 0);
+		}
+		return scope.Escape(make_object(isolate, buffer, 0, span, value.shape(), value.strides()));
+	}
+
+	static to_type to_v8(v8::Isolate* isolate, from_type&& value)
+	{
+		if (!value.owns_data())
+		{
+			return to_v8(isolate, static_cast<from_type const&>(value));
+		}
+
+		v8::EscapableHandleScope scope(isolate);
+
+		size_t const span = value.span();
+		typename from_type::shape_type const shape = value.shape();
+		typename from_type::shape_type const strides = value.strides();
+		size_t offset;
+		v8::Local<v8::ArrayBuffer> buffer = detail::vector_array_buffer(isolate, value.release(offset));
+		return scope.Escape(make_object(isolate, buffer, offset, span, shape, strides));
+	}
+
+private:
+	static v8::Local<v8::Object> make_object(v8::Isolate* isolate, v8::Local<v8::ArrayBuffer> buffer,
+		size_t offset, size_t length, typename from_type::shape_type const& shape,
+		typename from_type::shape_type const& strides)
+	{
+		v8::Local<v8::Object> result = v8::Object::New(isolate);
+		result->Set(v8::String::NewFromUtf8(isolate, "data"),
+			typed_array_type::create(buffer, offset * sizeof(T), length));
+		result->Set(v8::String::NewFromUtf8(isolate, "shape"), detail::dims_to_v8(isolate, shape));
+		result->Set(v8::String::NewFromUtf8(isolate, "strides"), detail::dims_to_v8(isolate, strides));
+		return result;
+	}
+};
+
+template<typename T>
+struct is_wrapped_class<ndarray<T>> : std::false_type {};
+
+/// Move ndarray storage into a new ArrayBuffer without copying
+template<typename T>
+v8::Handle<v8::Object> to_v8(v8::Isolate* isolate, ndarray<T>&& value)
+{
+	return convert<ndarray<T>>::to_v8(isolate, std::move(value));
+}
+
+} // namespace v8pp
+
+#endif // V8PP_NDARRAY_HPP_INCLUDED
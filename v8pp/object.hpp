@@ -1,10 +1,17 @@
 #ifndef V8PP_OBJECT_HPP_INCLUDED
 #define V8PP_OBJECT_HPP_INCLUDED
 
+#include <algorithm>
 #include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <v8.h>
 
 #include "v8pp/convert.hpp"
+#include "v8pp/persistent.hpp"
 
 namespace v8pp {
 
@@ -63,6 +70,213 @@ void set_const(v8::Isolate* isolate, v8::Handle<v8::Object> options,
 		v8::PropertyAttribute(v8::ReadOnly | v8::DontDelete));
 }
 
+/// Precompiled option name for get_option/set_option.
+/// Dot symbols in option name delimits subobjects name,
+/// the name segments are split and internalized once.
+class option_path
+{
+public:
+	/// Maximum number of name segments
+	static size_t const max_depth = 16;
+
+	option_path(v8::Isolate* isolate, char const* name)
+		: isolate_(isolate)
+		, name_(name)
+	{
+		for (char const* segment = name; ; )
+		{
+			char const* dot = strchr(segment, '.');
+			size_t const length = dot? dot - segment : strlen(segment);
+			segments_.emplace_back(isolate, v8::String::NewFromUtf8(isolate, segment,
+				v8::String::kInternalizedString, static_cast<int>(length)));
+			if (!dot) break;
+			segment = dot + 1;
+		}
+		if (segments_.size() > max_depth)
+		{
+			throw std::invalid_argument("too many segments in option name " + name_);
+		}
+	}
+
+	/// V8 isolate of the internalized name segments
+	v8::Isolate* isolate() const { return isolate_; }
+
+	/// Option name
+	std::string const& name() const { return name_; }
+
+	/// Number of name segments
+	size_t size() const { return segments_.size(); }
+
+	/// Internalized name segment
+	v8::Local<v8::String> segment(size_t index) const
+	{
+		return v8::Local<v8::String>::New(isolate_, segments_[index]);
+	}
+
+	/// Get option value from V8 object,
+	/// return false if the value doesn't exist in the options object
+	template<typename T>
+	bool get(v8::Handle<v8::Object> options, T& value) const
+	{
+		v8::Local<v8::Value> val = options;
+		for (size_t i = 0; i < segments_.size(); ++i)
+		{
+			// a throwing getter returns an empty value
+			if (val.IsEmpty() || !val->IsObject())
+			{
+				return false;
+			}
+			val = val.As<v8::Object>()->Get(segment(i));
+		}
+		if (val.IsEmpty() || val->IsUndefined())
+		{
+			return false;
+		}
+		value = from_v8<T>(isolate_, val);
+		return true;
+	}
+
+	/// Set option value in V8 object,
+	/// return false if the value doesn't exists in the options subobject
+	template<typename T>
+	bool set(v8::Handle<v8::Object> options, T const& value) const
+	{
+		v8::Local<v8::Value> val = options;
+		size_t const last = segments_.size() - 1;
+		for (size_t i = 0; i < last; ++i)
+		{
+			val = val.As<v8::Object>()->Get(segment(i));
+			if (val.IsEmpty() || !val->IsObject())
+			{
+				return false;
+			}
+		}
+		val.As<v8::Object>()->Set(segment(last), to_v8(isolate_, value));
+		return true;
+	}
+
+private:
+	v8::Isolate* isolate_;
+	std::string name_;
+	std::vector<persistent<v8::String>> segments_;
+};
+
+/// List of precompiled option names for get_options()
+class option_paths
+{
+public:
+	option_paths(v8::Isolate* isolate, std::initializer_list<char const*> names)
+	{
+		paths_.reserve(names.size());
+		shared_.reserve(names.size());
+		for (char const* name : names)
+		{
+			paths_.emplace_back(isolate, name);
+			shared_.push_back(paths_.size() > 1? common_prefix(paths_[paths_.size() - 2], paths_.back()) : 0);
+		}
+	}
+
+	/// Number of option names
+	size_t size() const { return paths_.size(); }
+
+	/// Option name at index
+	option_path const& operator[](size_t index) const { return paths_[index]; }
+
+	/// Number of subobjects in the option name at index
+	/// shared with the previous option name
+	size_t shared_prefix(size_t index) const { return shared_[index]; }
+
+private:
+	static size_t common_prefix(option_path const& path1, option_path const& path2)
+	{
+		// the last segment is the option itself, not a subobject
+		size_t const max_shared = std::min(path1.size(), path2.size()) - 1;
+		size_t shared = 0;
+		while (shared < max_shared && path1.segment(shared)->StrictEquals(path2.segment(shared)))
+		{
+			++shared;
+		}
+		return shared;
+	}
+
+	std::vector<option_path> paths_;
+	std::vector<size_t> shared_;
+};
+
+namespace detail {
+
+// Subobjects found for the last option name, reused for the next one
+class option_lookup
+{
+public:
+	option_lookup(v8::Handle<v8::Object> options, option_paths const& paths)
+		: paths_(paths)
+		, depth_(0)
+	{
+		objects_[0] = options;
+	}
+
+	template<typename T>
+	bool get(size_t index, T& value)
+	{
+		option_path const& path = paths_[index];
+		size_t level = std::min(paths_.shared_prefix(index), depth_);
+		for (; level < path.size(); ++level)
+		{
+			v8::Local<v8::Value> obj = objects_[level];
+			if (obj.IsEmpty() || !obj->IsObject())
+			{
+				depth_ = level;
+				return false;
+			}
+			objects_[level + 1] = obj.As<v8::Object>()->Get(path.segment(level));
+		}
+		depth_ = level - 1;
+
+		v8::Local<v8::Value> const val = objects_[level];
+		if (val.IsEmpty() || val->IsUndefined())
+		{
+			return false;
+		}
+		value = from_v8<T>(path.isolate(), val);
+		return true;
+	}
+
+private:
+	option_paths const& paths_;
+	// objects_[i] is a value after i name segments, objects_[0] is options
+	v8::Local<v8::Value> objects_[option_path::max_depth + 1];
+	size_t depth_;
+};
+
+inline size_t get_options(option_lookup&, size_t)
+{
+	return 0;
+}
+
+template<typename T, typename ...Ts>
+size_t get_options(option_lookup& lookup, size_t index, T& value, Ts&... values)
+{
+	size_t const found = lookup.get(index, value)? 1 : 0;
+	return found + get_options(lookup, index + 1, values...);
+}
+
+} // namespace detail
+
+/// Get several optional values from V8 object by precompiled names,
+/// subobjects of adjacent names with common prefix are looked up once.
+/// return number of values existing in the options object
+template<typename ...Ts>
+size_t get_options(v8::Handle<v8::Object> options, option_paths const& paths, Ts&... values)
+{
+	if (paths.size() != sizeof...(Ts))
+	{
+		throw std::invalid_argument("get_options: number of values doesn't match number of paths");
+	}
+	detail::option_lookup lookup(options, paths);
+	return detail::get_options(lookup, 0, values...);
+}
+
 } // namespace v8pp
 
 #endif // V8PP_OBJECT_HPP_INCLUDED
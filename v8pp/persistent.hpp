@@ -1,6 +1,11 @@
 #ifndef V8PP_PERSISTENT_HPP_INCLUDED
 #define V8PP_PERSISTENT_HPP_INCLUDED
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 #include <v8.h>
 
 #include "v8pp/convert.hpp"
@@ -156,6 +161,112 @@ private:
 	v8::UniquePersistent<v8::Value> handle_;
 };
 
+/// Cache of V8 values by C++ keys with weak persistent handles.
+/// An entry is evicted when its value is garbage collected.
+/// Values should be objects or strings, other primitives can't be weak
+template<typename Key, typename T = v8::Value, typename Hash = std::hash<Key>>
+class weak_cache
+{
+public:
+	/// Cache usage counters
+	struct stats
+	{
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t evictions; // entries evicted by GC
+	};
+
+	explicit weak_cache(v8::Isolate* isolate)
+		: isolate_(isolate)
+	{
+		stats_.hits = stats_.misses = stats_.evictions = 0;
+	}
+
+	weak_cache(weak_cache const&) = delete;
+	weak_cache& operator=(weak_cache const&) = delete;
+
+	/// V8 isolate of the cached values
+	v8::Isolate* isolate() { return isolate_; }
+
+	/// Number of cached values
+	size_t size() const { return entries_.size(); }
+
+	/// Usage counters
+	stats const& statistics() const { return stats_; }
+
+	/// Find a cached value, return empty handle on miss
+	v8::Local<T> get(Key const& key)
+	{
+		auto const it = entries_.find(key);
+		if (it == entries_.end())
+		{
+			++stats_.misses;
+			return v8::Local<T>();
+		}
+		++stats_.hits;
+		return v8::Local<T>::New(isolate_, it->second->handle);
+	}
+
+	/// Find a cached value or create and cache it with `create()` function
+	template<typename Create>
+	v8::Local<T> get_or_create(Key const& key, Create create)
+	{
+		v8::Local<T> value = get(key);
+		if (value.IsEmpty())
+		{
+			value = create();
+			set(key, value);
+		}
+		return value;
+	}
+
+	/// Cache a value for the key, replacing existing one
+	void set(Key const& key, v8::Handle<T> value)
+	{
+		std::unique_ptr<entry>& ptr = entries_[key];
+		if (!ptr)
+		{
+			ptr.reset(new entry(this, key));
+		}
+		ptr->handle.Reset(isolate_, value);
+		ptr->handle.SetWeak(ptr.get(), &weak_cache::collected);
+	}
+
+	/// Remove a cached value for the key, return false if not found
+	bool erase(Key const& key)
+	{
+		return entries_.erase(key) != 0;
+	}
+
+	/// Remove all cached values
+	void clear()
+	{
+		entries_.clear();
+	}
+
+private:
+	struct entry
+	{
+		weak_cache* cache;
+		Key key;
+		persistent<T> handle;
+
+		entry(weak_cache* cache, Key const& key) : cache(cache), key(key) {}
+	};
+
+	static void collected(v8::WeakCallbackData<T, entry> const& data)
+	{
+		entry* e = data.GetParameter();
+		weak_cache* cache = e->cache;
+		++cache->stats_.evictions;
+		cache->entries_.erase(e->key);
+	}
+
+	v8::Isolate* isolate_;
+	std::unordered_map<Key, std::unique_ptr<entry>, Hash> entries_;
+	stats stats_;
+};
+
 } // namespace v8pp
 
 #endif // V8PP_PERSISTENT_HPP_INCLUDED
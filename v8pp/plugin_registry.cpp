@@ -0,0 +1,268 @@
+#include "v8pp/plugin_registry.hpp"
+#include "v8pp/config.hpp"
+#include "v8pp/convert.hpp"
+#include "v8pp/isolate_data.hpp"
+#include "v8pp/persistent.hpp"
+
+#include <stdexcept>
+
+#if defined(WIN32)
+#include <windows.h>
+static char const path_sep = '\\';
+#else
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+static char const path_sep = '/';
+#endif
+
+#define STRINGIZE(s) STRINGIZE0(s)
+#define STRINGIZE0(s) #s
+
+namespace v8pp {
+
+static bool has_suffix(std::string const& str, std::string const& suffix)
+{
+	return str.size() >= suffix.size()
+		&& str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// both separators and a drive letter, as in context require()
+static bool has_path_sep(std::string const& name)
+{
+	return name.find_first_of("\\/:") != name.npos;
+}
+
+static bool file_exists(std::string const& filename)
+{
+#if defined(WIN32)
+	DWORD const attrs = ::GetFileAttributesA(filename.c_str());
+	return attrs != INVALID_FILE_ATTRIBUTES && !(attrs & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	struct stat st;
+	return stat(filename.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+#endif
+}
+
+static void* open_library(std::string const& filename)
+{
+#if defined(WIN32)
+	UINT const prev_error_mode = SetErrorMode(SEM_NOOPENFILEERRORBOX);
+	void* handle = LoadLibraryA(filename.c_str());
+	::SetErrorMode(prev_error_mode);
+	return handle;
+#else
+	return dlopen(filename.c_str(), RTLD_LAZY);
+#endif
+}
+
+static void close_library(void* handle)
+{
+#if defined(WIN32)
+	::FreeLibrary((HMODULE)handle);
+#else
+	dlclose(handle);
+#endif
+}
+
+// list plugin files in a directory, name without suffix => filename
+template<typename Files>
+static void list_plugin_files(std::string const& lib_path, Files& files)
+{
+	std::string const suffix = V8PP_PLUGIN_SUFFIX;
+#if defined(WIN32)
+	WIN32_FIND_DATAA data;
+	HANDLE find = ::FindFirstFileA((lib_path + path_sep + '*' + suffix).c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	do
+	{
+		std::string const filename = data.cFileName;
+		if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && has_suffix(filename, suffix))
+		{
+			files[filename.substr(0, filename.size() - suffix.size())] = lib_path + path_sep + filename;
+		}
+	} while (::FindNextFileA(find, &data));
+	::FindClose(find);
+#else
+	DIR* dir = opendir(lib_path.c_str());
+	if (!dir)
+	{
+		return;
+	}
+	while (dirent* entry = readdir(dir))
+	{
+		std::string const filename = entry->d_name;
+		if (has_suffix(filename, suffix))
+		{
+			files[filename.substr(0, filename.size() - suffix.size())] = lib_path + path_sep + filename;
+		}
+	}
+	closedir(dir);
+#endif
+}
+
+plugin_registry::library::library(std::string const& filename, void* handle, init_proc init)
+	: filename_(filename)
+	, handle_(handle)
+	, init_(init)
+{
+}
+
+plugin_registry::library::~library()
+{
+	close_library(handle_);
+}
+
+plugin_registry& plugin_registry::instance()
+{
+	static plugin_registry instance;
+	return instance;
+}
+
+std::string plugin_registry::find(std::string const& lib_path, std::string const& name)
+{
+	std::string const suffix = V8PP_PLUGIN_SUFFIX;
+	std::string const filename = has_suffix(name, suffix)? name : name + suffix;
+	if (has_path_sep(name))
+	{
+		return file_exists(filename)? filename : std::string();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto it = lib_paths_.find(lib_path);
+	if (it == lib_paths_.end())
+	{
+		it = lib_paths_.emplace(lib_path, plugin_files()).first;
+		if (!lib_path.empty())
+		{
+			list_plugin_files(lib_path, it->second);
+		}
+	}
+
+	plugin_files& files = it->second;
+	std::string const key = filename.substr(0, filename.size() - suffix.size());
+	auto file = files.find(key);
+	if (file == files.end() && lib_path.empty())
+	{
+		// a bare name is resolved by the dynamic loader search path,
+		// probe it once and cache the result, missing names as empty
+		void* handle = open_library(filename);
+		if (handle)
+		{
+			close_library(handle);
+		}
+		file = files.emplace(key, handle? filename : std::string()).first;
+	}
+	return file != files.end()? file->second : std::string();
+}
+
+void plugin_registry::rescan(std::string const& lib_path)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	lib_paths_.erase(lib_path);
+}
+
+std::shared_ptr<plugin_registry::library> plugin_registry::load(std::string const& filename)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	std::weak_ptr<library>& cached = libraries_[filename];
+	std::shared_ptr<library> result = cached.lock();
+	if (result)
+	{
+		return result;
+	}
+
+	void* handle = open_library(filename);
+	if (!handle)
+	{
+		libraries_.erase(filename);
+		throw std::runtime_error("could not load shared library " + filename);
+	}
+
+#if defined(WIN32)
+	void *sym = ::GetProcAddress((HMODULE)handle, STRINGIZE(V8PP_PLUGIN_INIT_PROC_NAME));
+#else
+	void *sym = dlsym(handle, STRINGIZE(V8PP_PLUGIN_INIT_PROC_NAME));
+#endif
+	// take ownership of the handle to close it on error
+	result.reset(new library(filename, handle, reinterpret_cast<init_proc>(sym)));
+	if (!sym)
+	{
+		libraries_.erase(filename);
+		throw std::runtime_error("initialization function "
+			STRINGIZE(V8PP_PLUGIN_INIT_PROC_NAME) " not found in " + filename);
+	}
+
+	cached = result;
+	return result;
+}
+
+size_t plugin_registry::size() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	size_t count = 0;
+	for (auto const& kv : libraries_)
+	{
+		if (!kv.second.expired())
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+namespace detail {
+
+// Plugin exports created in an isolate, by library filename
+struct plugin_exports
+{
+	struct plugin
+	{
+		// declared first to unload the library after exports reset
+		std::shared_ptr<plugin_registry::library> library;
+		persistent<v8::Value> exports;
+	};
+
+	explicit plugin_exports(v8::Isolate*) {}
+
+	std::map<std::string, plugin> plugins;
+};
+
+} // namespace detail
+
+v8::Handle<v8::Value> require_plugin(v8::Isolate* isolate,
+	std::string const& lib_path, std::string const& name)
+{
+	plugin_registry& registry = plugin_registry::instance();
+
+	std::string const filename = registry.find(lib_path, name);
+	if (filename.empty())
+	{
+		throw std::runtime_error("could not locate plugin " + name + " in " + lib_path);
+	}
+
+	v8::EscapableHandleScope scope(isolate);
+
+	detail::plugin_exports& data = detail::isolate_data::get<detail::plugin_exports>(isolate);
+	auto it = data.plugins.find(filename);
+	if (it != data.plugins.end())
+	{
+		return scope.Escape(to_local(isolate, it->second.exports));
+	}
+
+	detail::plugin_exports::plugin plugin;
+	plugin.library = registry.load(filename);
+	// the plugin initialization may require other plugins
+	v8::Local<v8::Value> exports = plugin.library->init()(isolate);
+	plugin.exports.Reset(isolate, exports);
+	data.plugins.emplace(filename, std::move(plugin));
+	return scope.Escape(exports);
+}
+
+} // namespace v8pp
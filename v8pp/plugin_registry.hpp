@@ -0,0 +1,91 @@
+#ifndef V8PP_PLUGIN_REGISTRY_HPP_INCLUDED
+#define V8PP_PLUGIN_REGISTRY_HPP_INCLUDED
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <v8.h>
+
+namespace v8pp {
+
+/// Process-wide registry of v8pp plugins loaded from shared libraries.
+/// A plugin library is loaded once and shared by all isolates and contexts,
+/// it is unloaded when the last user releases it.
+class plugin_registry
+{
+public:
+	/// Plugin initialization function, see V8PP_PLUGIN_INIT
+	using init_proc = v8::Handle<v8::Value>(*)(v8::Isolate*);
+
+	class library;
+
+	/// Process-wide registry instance
+	static plugin_registry& instance();
+
+	plugin_registry(plugin_registry const&) = delete;
+	plugin_registry& operator=(plugin_registry const&) = delete;
+
+	/// Resolve a plugin name to its library filename. Plugin files in lib_path
+	/// are listed once and cached, so a missing plugin is reported without
+	/// probing the file system. With empty lib_path a name is looked up once
+	/// by the dynamic loader search path and cached. A name with path separators
+	/// is checked in the file system directly.
+	/// Returns empty string if the plugin is not found.
+	std::string find(std::string const& lib_path, std::string const& name);
+
+	/// Drop cached listing of lib_path, to find plugins added later.
+	/// Empty lib_path drops cached loader search path lookups
+	void rescan(std::string const& lib_path);
+
+	/// Load a plugin library or share the already loaded one,
+	/// throws std::runtime_error on failure
+	std::shared_ptr<library> load(std::string const& filename);
+
+	/// Number of loaded plugin libraries
+	size_t size() const;
+
+private:
+	plugin_registry() = default;
+
+	using plugin_files = std::map<std::string, std::string>;
+
+	mutable std::mutex mutex_;
+	std::map<std::string, std::weak_ptr<library>> libraries_;
+	std::map<std::string, plugin_files> lib_paths_;
+};
+
+/// Loaded plugin library with resolved initialization function
+class plugin_registry::library
+{
+public:
+	~library();
+
+	library(library const&) = delete;
+	library& operator=(library const&) = delete;
+
+	/// Library filename
+	std::string const& filename() const { return filename_; }
+
+	/// Plugin initialization function
+	init_proc init() const { return init_; }
+
+private:
+	friend class plugin_registry;
+	library(std::string const& filename, void* handle, init_proc init);
+
+	std::string filename_;
+	void* handle_;
+	init_proc init_;
+};
+
+/// Require a plugin in the isolate. The plugin library is shared via
+/// plugin_registry, its exports are created once per isolate.
+/// Throws std::runtime_error on failure.
+v8::Handle<v8::Value> require_plugin(v8::Isolate* isolate,
+	std::string const& lib_path, std::string const& name);
+
+} // namespace v8pp
+
+#endif // V8PP_PLUGIN_REGISTRY_HPP_INCLUDED
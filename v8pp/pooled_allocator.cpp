@@ -0,0 +1,238 @@
+#include "v8pp/pooled_allocator.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+#define V8PP_HUGE_PAGES
+#endif
+
+namespace v8pp {
+
+// smallest size class is 2^min_class_shift bytes
+static unsigned const min_class_shift = 4;
+
+#if defined(V8PP_HUGE_PAGES)
+static size_t const huge_page_size = 2 * 1024 * 1024;
+
+static size_t round_up(size_t size, size_t alignment)
+{
+	return (size + alignment - 1) / alignment * alignment;
+}
+#endif
+
+pooled_allocator::pooled_allocator(options const& opts)
+	: options_(opts)
+	, allocations_(0)
+	, reused_(0)
+	, frees_(0)
+	, huge_page_allocations_(0)
+	, allocated_size_(0)
+	, cached_size_(0)
+{
+	for (size_t size = size_t(1) << min_class_shift; size / 2 < options_.max_pooled_size; size *= 2)
+	{
+		classes_.emplace_back(new size_class);
+	}
+}
+
+pooled_allocator::~pooled_allocator()
+{
+	trim();
+}
+
+pooled_allocator& pooled_allocator::instance()
+{
+	static pooled_allocator instance;
+	return instance;
+}
+
+pooled_allocator::size_class* pooled_allocator::find_class(size_t length, size_t& class_size)
+{
+	if (length > options_.max_pooled_size)
+	{
+		return nullptr;
+	}
+	size_t index = 0;
+	class_size = size_t(1) << min_class_shift;
+	while (class_size < length)
+	{
+		class_size *= 2;
+		++index;
+	}
+	return index < classes_.size()? classes_[index].get() : nullptr;
+}
+
+bool pooled_allocator::use_huge_pages(size_t length) const
+{
+#if defined(V8PP_HUGE_PAGES)
+	return options_.huge_pages && length >= huge_page_size && length > options_.max_pooled_size;
+#else
+	(void)length;
+	return false;
+#endif
+}
+
+void* pooled_allocator::allocate(size_t length, bool zero_fill)
+{
+	++allocations_;
+
+	size_t class_size;
+	if (size_class* cls = find_class(length, class_size))
+	{
+		void* data = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(cls->mutex);
+			if (!cls->free_list.empty())
+			{
+				data = cls->free_list.back();
+				cls->free_list.pop_back();
+			}
+		}
+		if (data)
+		{
+			++reused_;
+			cached_size_ -= class_size;
+			if (zero_fill)
+			{
+				std::memset(data, 0, length);
+			}
+		}
+		else
+		{
+			data = zero_fill? std::calloc(1, class_size) : std::malloc(class_size);
+			if (!data)
+			{
+				return nullptr;
+			}
+		}
+		allocated_size_ += class_size;
+		return data;
+	}
+
+#if defined(V8PP_HUGE_PAGES)
+	if (use_huge_pages(length))
+	{
+		// anonymous mapping is zero-filled
+		size_t const size = round_up(length, huge_page_size);
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data != MAP_FAILED)
+		{
+			madvise(data, size, MADV_HUGEPAGE);
+			++huge_page_allocations_;
+			allocated_size_ += size;
+			return data;
+		}
+
+		// the rounded up size may not fit, try a regular allocation
+		data = zero_fill? std::calloc(1, length) : std::malloc(length);
+		if (data)
+		{
+			std::lock_guard<std::mutex> lock(fallback_mutex_);
+			fallback_.insert(data);
+			allocated_size_ += length;
+		}
+		return data;
+	}
+#endif
+
+	void* data = zero_fill? std::calloc(1, length) : std::malloc(length);
+	if (data)
+	{
+		allocated_size_ += length;
+	}
+	return data;
+}
+
+void* pooled_allocator::Allocate(size_t length)
+{
+	return allocate(length, true);
+}
+
+void* pooled_allocator::AllocateUninitialized(size_t length)
+{
+	return allocate(length, false);
+}
+
+void pooled_allocator::Free(void* data, size_t length)
+{
+	if (!data)
+	{
+		return;
+	}
+	++frees_;
+
+	size_t class_size;
+	if (size_class* cls = find_class(length, class_size))
+	{
+		allocated_size_ -= class_size;
+		if (cached_size_ + class_size <= options_.max_cached_size)
+		{
+			cached_size_ += class_size;
+			std::lock_guard<std::mutex> lock(cls->mutex);
+			cls->free_list.push_back(data);
+			return;
+		}
+		std::free(data);
+		return;
+	}
+
+#if defined(V8PP_HUGE_PAGES)
+	if (use_huge_pages(length))
+	{
+		{
+			std::lock_guard<std::mutex> lock(fallback_mutex_);
+			if (fallback_.erase(data))
+			{
+				std::free(data);
+				allocated_size_ -= length;
+				return;
+			}
+		}
+		size_t const size = round_up(length, huge_page_size);
+		munmap(data, size);
+		allocated_size_ -= size;
+		return;
+	}
+#endif
+
+	std::free(data);
+	allocated_size_ -= length;
+}
+
+pooled_allocator::stats pooled_allocator::statistics() const
+{
+	stats result;
+	result.allocations = allocations_;
+	result.reused = reused_;
+	result.frees = frees_;
+	result.huge_page_allocations = huge_page_allocations_;
+	result.allocated_size = allocated_size_;
+	result.cached_size = cached_size_;
+	return result;
+}
+
+void pooled_allocator::trim()
+{
+	size_t class_size = size_t(1) << min_class_shift;
+	for (auto& cls : classes_)
+	{
+		std::vector<void*> free_list;
+		{
+			std::lock_guard<std::mutex> lock(cls->mutex);
+			free_list.swap(cls->free_list);
+		}
+		for (void* data : free_list)
+		{
+			std::free(data);
+		}
+		cached_size_ -= free_list.size() * class_size;
+		class_size *= 2;
+	}
+}
+
+} // namespace v8pp
@@ -0,0 +1,108 @@
+#ifndef V8PP_POOLED_ALLOCATOR_HPP_INCLUDED
+#define V8PP_POOLED_ALLOCATOR_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <v8.h>
+
+namespace v8pp {
+
+/// pooled_allocator options
+struct pooled_allocator_options
+{
+	/// Largest pooled buffer size, larger buffers are not pooled
+	size_t max_pooled_size = 1024 * 1024;
+
+	/// Limit of total size of free buffers kept for reuse
+	size_t max_cached_size = 64 * 1024 * 1024;
+
+	/// Allocate buffers not smaller than huge page size on huge pages,
+	/// where the system supports it. Falls back to malloc when mapping fails
+	bool huge_pages = false;
+};
+
+/// ArrayBuffer allocator with free lists of power of 2 size classes.
+/// Freed buffers are kept for reuse up to a cache limit, uninitialized
+/// allocations are not zero-filled. Buffers larger than the pooled size
+/// are allocated directly, optionally on transparent huge pages.
+/// Thread-safe, may be shared by isolates in several threads.
+class pooled_allocator : public v8::ArrayBuffer::Allocator
+{
+public:
+	using options = pooled_allocator_options;
+
+	/// Allocator statistics
+	struct stats
+	{
+		/// Number of allocations
+		uint64_t allocations;
+		/// Number of allocations served from the free lists
+		uint64_t reused;
+		/// Number of frees
+		uint64_t frees;
+		/// Number of allocations on huge pages
+		uint64_t huge_page_allocations;
+		/// Size of allocated buffers, in bytes
+		size_t allocated_size;
+		/// Size of free buffers kept for reuse, in bytes
+		size_t cached_size;
+	};
+
+	explicit pooled_allocator(options const& opts = options());
+	~pooled_allocator();
+
+	pooled_allocator(pooled_allocator const&) = delete;
+	pooled_allocator& operator=(pooled_allocator const&) = delete;
+
+	/// Process-wide allocator instance with default options
+	static pooled_allocator& instance();
+
+	/// Allocate zero-filled buffer
+	virtual void* Allocate(size_t length) override;
+
+	/// Allocate buffer without zero fill
+	virtual void* AllocateUninitialized(size_t length) override;
+
+	/// Free buffer, pooled sizes return to a free list
+	virtual void Free(void* data, size_t length) override;
+
+	/// Current allocator statistics
+	stats statistics() const;
+
+	/// Release all cached free buffers
+	void trim();
+
+private:
+	struct size_class
+	{
+		std::mutex mutex;
+		std::vector<void*> free_list;
+	};
+
+	size_class* find_class(size_t length, size_t& class_size);
+	bool use_huge_pages(size_t length) const;
+	void* allocate(size_t length, bool zero_fill);
+
+	options const options_;
+	std::vector<std::unique_ptr<size_class>> classes_;
+
+	std::atomic<uint64_t> allocations_;
+	std::atomic<uint64_t> reused_;
+	std::atomic<uint64_t> frees_;
+	std::atomic<uint64_t> huge_page_allocations_;
+	std::atomic<size_t> allocated_size_;
+	std::atomic<size_t> cached_size_;
+
+	// huge page size buffers allocated with malloc after a failed mapping
+	std::mutex fallback_mutex_;
+	std::unordered_set<void*> fallback_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_POOLED_ALLOCATOR_HPP_INCLUDED
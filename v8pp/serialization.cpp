@@ -0,0 +1,555 @@
+#include "v8pp/serialization.hpp"
+#include "v8pp/bytes.hpp"
+#include "v8pp/convert.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace v8pp {
+
+namespace {
+
+uint8_t const format_version = 1;
+
+enum tag : uint8_t
+{
+	tag_undefined = '_',
+	tag_null = '0',
+	tag_true = 'T',
+	tag_false = 'F',
+	tag_int32 = 'I',
+	tag_double = 'N',
+	tag_string = 'S',
+	tag_date = 'D',
+	tag_array = 'A',
+	tag_object = 'o',
+	tag_array_buffer = 'B',
+	tag_transferred = 't',
+	tag_view = 'V',
+	tag_ref = '^',
+};
+
+enum view_type : uint8_t
+{
+	view_uint8,
+	view_uint8_clamped,
+	view_int8,
+	view_uint16,
+	view_int16,
+	view_uint32,
+	view_int32,
+	view_float32,
+	view_float64,
+	view_data_view,
+};
+
+size_t const view_element_size[] = { 1, 1, 1, 2, 2, 4, 4, 4, 8, 1 };
+
+view_type get_view_type(v8::Local<v8::Value> view)
+{
+	if (view->IsUint8Array()) return view_uint8;
+	if (view->IsUint8ClampedArray()) return view_uint8_clamped;
+	if (view->IsInt8Array()) return view_int8;
+	if (view->IsUint16Array()) return view_uint16;
+	if (view->IsInt16Array()) return view_int16;
+	if (view->IsUint32Array()) return view_uint32;
+	if (view->IsInt32Array()) return view_int32;
+	if (view->IsFloat32Array()) return view_float32;
+	if (view->IsFloat64Array()) return view_float64;
+	return view_data_view;
+}
+
+v8::Local<v8::Object> new_view(view_type type, v8::Local<v8::ArrayBuffer> buffer, size_t offset, size_t length)
+{
+	switch (type)
+	{
+	case view_uint8: return v8::Uint8Array::New(buffer, offset, length);
+	case view_uint8_clamped: return v8::Uint8ClampedArray::New(buffer, offset, length);
+	case view_int8: return v8::Int8Array::New(buffer, offset, length);
+	case view_uint16: return v8::Uint16Array::New(buffer, offset, length);
+	case view_int16: return v8::Int16Array::New(buffer, offset, length);
+	case view_uint32: return v8::Uint32Array::New(buffer, offset, length);
+	case view_int32: return v8::Int32Array::New(buffer, offset, length);
+	case view_float32: return v8::Float32Array::New(buffer, offset, length);
+	case view_float64: return v8::Float64Array::New(buffer, offset, length);
+	case view_data_view: return v8::DataView::New(buffer, offset, length);
+	}
+	throw std::runtime_error("deserialize: invalid view type");
+}
+
+using detail::array_buffer_data;
+
+class writer
+{
+public:
+	writer(v8::Isolate* isolate, std::vector<uint8_t>& data,
+		std::vector<v8::Local<v8::ArrayBuffer>> const& transfer)
+		: isolate_(isolate)
+		, data_(data)
+		, transfer_(transfer)
+	{
+	}
+
+	void write(v8::Local<v8::Value> value)
+	{
+		if (value->IsUndefined())
+		{
+			write_byte(tag_undefined);
+		}
+		else if (value->IsNull())
+		{
+			write_byte(tag_null);
+		}
+		else if (value->IsTrue())
+		{
+			write_byte(tag_true);
+		}
+		else if (value->IsFalse())
+		{
+			write_byte(tag_false);
+		}
+		else if (value->IsInt32())
+		{
+			int32_t const n = value->Int32Value();
+			write_byte(tag_int32);
+			// zigzag encoding for small negative numbers
+			write_varint((static_cast<uint32_t>(n) << 1) ^ static_cast<uint32_t>(n >> 31));
+		}
+		else if (value->IsNumber())
+		{
+			write_byte(tag_double);
+			write_double(value->NumberValue());
+		}
+		else if (value->IsString())
+		{
+			write_byte(tag_string);
+			write_string(value.As<v8::String>());
+		}
+		else if (value->IsObject())
+		{
+			write_object(value.As<v8::Object>());
+		}
+		else
+		{
+			throw std::runtime_error("serialize: unsupported value type");
+		}
+	}
+
+private:
+	void write_object(v8::Local<v8::Object> obj)
+	{
+		if (write_ref(obj))
+		{
+			return;
+		}
+
+		if (obj->IsDate())
+		{
+			write_byte(tag_date);
+			write_double(obj.As<v8::Date>()->ValueOf());
+		}
+		else if (obj->IsArrayBuffer())
+		{
+			v8::Local<v8::ArrayBuffer> buffer = obj.As<v8::ArrayBuffer>();
+			auto const it = std::find(transfer_.begin(), transfer_.end(), buffer);
+			if (it != transfer_.end())
+			{
+				write_byte(tag_transferred);
+				write_varint(it - transfer_.begin());
+			}
+			else
+			{
+				size_t const length = buffer->ByteLength();
+				write_byte(tag_array_buffer);
+				write_varint(length);
+				write_bytes(array_buffer_data(buffer), length);
+			}
+		}
+		else if (obj->IsArrayBufferView())
+		{
+			v8::Local<v8::ArrayBufferView> view = obj.As<v8::ArrayBufferView>();
+			write_byte(tag_view);
+			write_byte(get_view_type(view));
+			write_varint(view->ByteOffset());
+			write_varint(view->ByteLength());
+			write_object(view->Buffer());
+		}
+		else if (is_host_object(obj))
+		{
+			// the C++ object may be destroyed before deserialization,
+			// or be used from another thread in the target isolate
+			throw std::runtime_error("serialize: host objects can't be passed between isolates");
+		}
+		else if (obj->IsFunction() || obj->IsRegExp() || obj->IsExternal() || obj->IsPromise())
+		{
+			throw std::runtime_error("serialize: unsupported object type");
+		}
+		else if (obj->IsArray())
+		{
+			v8::Local<v8::Array> arr = obj.As<v8::Array>();
+			uint32_t const length = arr->Length();
+			write_byte(tag_array);
+			write_varint(length);
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				write(arr->Get(i));
+			}
+		}
+		else
+		{
+			v8::Local<v8::Array> names = obj->GetOwnPropertyNames();
+			uint32_t const count = names->Length();
+			write_byte(tag_object);
+			write_varint(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				v8::Local<v8::Value> name = names->Get(i);
+				write_string(name->ToString());
+				write(obj->Get(name));
+			}
+		}
+	}
+
+	// Write a reference to already serialized object, or assign a new id to it
+	bool write_ref(v8::Local<v8::Object> obj)
+	{
+		int const hash = obj->GetIdentityHash();
+		auto const range = ids_.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (objects_[it->second]->StrictEquals(obj))
+			{
+				write_byte(tag_ref);
+				write_varint(it->second);
+				return true;
+			}
+		}
+		ids_.emplace(hash, static_cast<uint32_t>(objects_.size()));
+		objects_.push_back(obj);
+		return false;
+	}
+
+	// objects of classes bound with v8pp::class_
+	static bool is_host_object(v8::Local<v8::Object> obj)
+	{
+		return obj->InternalFieldCount() == 2 && obj->GetAlignedPointerFromInternalField(1);
+	}
+
+	void write_byte(uint8_t byte)
+	{
+		data_.push_back(byte);
+	}
+
+	void write_bytes(void const* bytes, size_t size)
+	{
+		uint8_t const* ptr = static_cast<uint8_t const*>(bytes);
+		data_.insert(data_.end(), ptr, ptr + size);
+	}
+
+	void write_varint(uint64_t n)
+	{
+		while (n >= 0x80)
+		{
+			data_.push_back(static_cast<uint8_t>(n) | 0x80);
+			n >>= 7;
+		}
+		data_.push_back(static_cast<uint8_t>(n));
+	}
+
+	void write_double(double n)
+	{
+		write_bytes(&n, sizeof(n));
+	}
+
+	void write_string(v8::Local<v8::String> str)
+	{
+		int const length = str->Utf8Length();
+		write_varint(length);
+		size_t const pos = data_.size();
+		data_.resize(pos + length);
+		str->WriteUtf8(reinterpret_cast<char*>(data_.data() + pos), length,
+			nullptr, v8::String::NO_NULL_TERMINATION);
+	}
+
+	v8::Isolate* isolate_;
+	std::vector<uint8_t>& data_;
+	std::vector<v8::Local<v8::ArrayBuffer>> const& transfer_;
+
+	// serialized objects, identity hash -> object id
+	std::unordered_multimap<int, uint32_t> ids_;
+	std::vector<v8::Local<v8::Object>> objects_;
+};
+
+class reader
+{
+public:
+	reader(v8::Isolate* isolate, uint8_t const* data, size_t size,
+		std::vector<v8::Local<v8::ArrayBuffer>> const& transferred)
+		: isolate_(isolate)
+		, ptr_(data)
+		, end_(data + size)
+		, transferred_(transferred)
+	{
+	}
+
+	bool at_end() const { return ptr_ == end_; }
+
+	v8::Local<v8::Value> read()
+	{
+		switch (read_byte())
+		{
+		case tag_undefined:
+			return v8::Undefined(isolate_);
+		case tag_null:
+			return v8::Null(isolate_);
+		case tag_true:
+			return v8::True(isolate_);
+		case tag_false:
+			return v8::False(isolate_);
+		case tag_int32:
+			{
+				uint32_t const n = static_cast<uint32_t>(read_varint());
+				return v8::Integer::New(isolate_, static_cast<int32_t>((n >> 1) ^ (0 - (n & 1))));
+			}
+		case tag_double:
+			return v8::Number::New(isolate_, read_double());
+		case tag_string:
+			return read_string();
+		case tag_date:
+			{
+				v8::Local<v8::Value> date = v8::Date::New(isolate_, read_double());
+				objects_.push_back(date.As<v8::Object>());
+				return date;
+			}
+		case tag_array:
+			{
+				uint32_t const length = read_length();
+				v8::Local<v8::Array> arr = v8::Array::New(isolate_, length);
+				objects_.push_back(arr);
+				for (uint32_t i = 0; i < length; ++i)
+				{
+					arr->Set(i, read());
+				}
+				return arr;
+			}
+		case tag_object:
+			{
+				uint32_t const count = read_length();
+				v8::Local<v8::Object> obj = v8::Object::New(isolate_);
+				objects_.push_back(obj);
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					v8::Local<v8::String> name = read_string();
+					obj->Set(name, read());
+				}
+				return obj;
+			}
+		case tag_array_buffer:
+			{
+				size_t const length = read_length();
+				v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate_, length);
+				std::memcpy(array_buffer_data(buffer), read_bytes(length), length);
+				objects_.push_back(buffer);
+				return buffer;
+			}
+		case tag_transferred:
+			{
+				size_t const index = read_varint();
+				if (index >= transferred_.size())
+				{
+					throw std::runtime_error("deserialize: transferred ArrayBuffer is not available");
+				}
+				objects_.push_back(transferred_[index]);
+				return transferred_[index];
+			}
+		case tag_view:
+			{
+				// view id is assigned before its buffer
+				size_t const id = objects_.size();
+				objects_.emplace_back();
+				uint8_t const type = read_byte();
+				size_t const offset = read_varint();
+				size_t const length = read_varint();
+				v8::Local<v8::Value> buffer = read();
+				if (type > view_data_view || !buffer->IsArrayBuffer()
+					|| offset + length > buffer.As<v8::ArrayBuffer>()->ByteLength()
+					|| length % view_element_size[type] != 0)
+				{
+					throw std::runtime_error("deserialize: invalid ArrayBuffer view");
+				}
+				objects_[id] = new_view(static_cast<view_type>(type), buffer.As<v8::ArrayBuffer>(),
+					offset, length / view_element_size[type]);
+				return objects_[id];
+			}
+		case tag_ref:
+			{
+				size_t const id = read_varint();
+				if (id >= objects_.size() || objects_[id].IsEmpty())
+				{
+					throw std::runtime_error("deserialize: invalid object reference");
+				}
+				return objects_[id];
+			}
+		default:
+			throw std::runtime_error("deserialize: invalid data");
+		}
+	}
+
+private:
+	uint8_t read_byte()
+	{
+		return *read_bytes(1);
+	}
+
+	uint8_t const* read_bytes(size_t size)
+	{
+		if (static_cast<size_t>(end_ - ptr_) < size)
+		{
+			throw std::runtime_error("deserialize: unexpected end of data");
+		}
+		uint8_t const* result = ptr_;
+		ptr_ += size;
+		return result;
+	}
+
+	uint64_t read_varint()
+	{
+		uint64_t n = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7)
+		{
+			uint8_t const byte = read_byte();
+			n |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return n;
+			}
+		}
+		throw std::runtime_error("deserialize: invalid data");
+	}
+
+	// length of data following in the input, at least 1 byte per element
+	uint32_t read_length()
+	{
+		uint64_t const length = read_varint();
+		if (length > static_cast<size_t>(end_ - ptr_))
+		{
+			throw std::runtime_error("deserialize: unexpected end of data");
+		}
+		return static_cast<uint32_t>(length);
+	}
+
+	double read_double()
+	{
+		double n;
+		std::memcpy(&n, read_bytes(sizeof(n)), sizeof(n));
+		return n;
+	}
+
+	v8::Local<v8::String> read_string()
+	{
+		uint32_t const length = read_length();
+		char const* str = reinterpret_cast<char const*>(read_bytes(length));
+		return v8::String::NewFromUtf8(isolate_, str, v8::String::kNormalString, length);
+	}
+
+	v8::Isolate* isolate_;
+	uint8_t const* ptr_;
+	uint8_t const* end_;
+	std::vector<v8::Local<v8::ArrayBuffer>> const& transferred_;
+	std::vector<v8::Local<v8::Object>> objects_;
+};
+
+} // unnamed namespace
+
+serialized_value::~serialized_value()
+{
+	free_transferred();
+}
+
+serialized_value::serialized_value(serialized_value&& src)
+	: data_(std::move(src.data_))
+	, transferred_(std::move(src.transferred_))
+{
+	src.transferred_.clear();
+}
+
+serialized_value& serialized_value::operator=(serialized_value&& src)
+{
+	if (&src != this)
+	{
+		free_transferred();
+		data_ = std::move(src.data_);
+		transferred_ = std::move(src.transferred_);
+		src.transferred_.clear();
+	}
+	return *this;
+}
+
+void serialized_value::free_transferred()
+{
+	for (array_buffer_contents const& contents : transferred_)
+	{
+		free_array_buffer(contents);
+	}
+	transferred_.clear();
+}
+
+serialized_value serialize(v8::Isolate* isolate, v8::Handle<v8::Value> value,
+	std::vector<v8::Local<v8::ArrayBuffer>> const& transfer)
+{
+	v8::HandleScope scope(isolate);
+
+	for (auto it = transfer.begin(); it != transfer.end(); ++it)
+	{
+		if (std::find(it + 1, transfer.end(), *it) != transfer.end())
+		{
+			throw std::runtime_error("serialize: duplicate ArrayBuffer in transfer list");
+		}
+		if (!can_release_array_buffer(*it))
+		{
+			throw std::runtime_error("serialize: ArrayBuffer in transfer list is not owned by the allocator");
+		}
+	}
+
+	serialized_value result;
+	result.data_.push_back(format_version);
+	writer(isolate, result.data_, transfer).write(value);
+
+	// move backing stores only after successful serialization
+	result.transferred_.reserve(transfer.size());
+	for (v8::Local<v8::ArrayBuffer> const& buffer : transfer)
+	{
+		result.transferred_.push_back(release_array_buffer(buffer));
+	}
+	return result;
+}
+
+v8::Handle<v8::Value> deserialize(v8::Isolate* isolate, serialized_value& value)
+{
+	v8::EscapableHandleScope scope(isolate);
+
+	if (value.data_.empty() || value.data_[0] != format_version)
+	{
+		throw std::runtime_error("deserialize: unsupported data format");
+	}
+
+	std::vector<v8::Local<v8::ArrayBuffer>> transferred;
+	transferred.reserve(value.transferred_.size());
+	for (array_buffer_contents const& contents : value.transferred_)
+	{
+		transferred.push_back(adopt_array_buffer(isolate, contents));
+	}
+	value.transferred_.clear();
+
+	reader input(isolate, value.data_.data() + 1, value.data_.size() - 1, transferred);
+	v8::Local<v8::Value> result = input.read();
+	if (!input.at_end())
+	{
+		throw std::runtime_error("deserialize: invalid data");
+	}
+	return scope.Escape(result);
+}
+
+} // namespace v8pp
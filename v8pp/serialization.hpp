@@ -0,0 +1,62 @@
+#ifndef V8PP_SERIALIZATION_HPP_INCLUDED
+#define V8PP_SERIALIZATION_HPP_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/array_buffer.hpp"
+
+namespace v8pp {
+
+/// V8 value serialized with serialize(), may be deserialized in another isolate.
+/// Owns backing stores of transferred ArrayBuffers until deserialization.
+class serialized_value
+{
+public:
+	serialized_value() = default;
+	~serialized_value();
+
+	serialized_value(serialized_value&& src);
+	serialized_value& operator=(serialized_value&& src);
+
+	serialized_value(serialized_value const&) = delete;
+	serialized_value& operator=(serialized_value const&) = delete;
+
+	/// Serialized data bytes
+	std::vector<uint8_t> const& data() const { return data_; }
+
+	/// Number of transferred ArrayBuffer backing stores
+	size_t transferred_count() const { return transferred_.size(); }
+
+private:
+	friend serialized_value serialize(v8::Isolate* isolate, v8::Handle<v8::Value> value,
+		std::vector<v8::Local<v8::ArrayBuffer>> const& transfer);
+	friend v8::Handle<v8::Value> deserialize(v8::Isolate* isolate, serialized_value& value);
+
+	void free_transferred();
+
+	std::vector<uint8_t> data_;
+	std::vector<array_buffer_contents> transferred_;
+};
+
+/// Serialize a V8 value into a compact byte buffer, like HTML structured clone:
+/// primitives, strings, dates, arrays, plain objects (own enumerable properties),
+/// ArrayBuffers, typed arrays and DataViews, with shared and circular references.
+/// ArrayBuffers in `transfer` list are moved instead of copied and neutered,
+/// this requires context_options::array_buffer_allocator.
+/// Throws std::runtime_error for values that can't be serialized, such as functions
+/// and objects of classes bound with v8pp::class_, owned by the source isolate.
+serialized_value serialize(v8::Isolate* isolate, v8::Handle<v8::Value> value,
+	std::vector<v8::Local<v8::ArrayBuffer>> const& transfer = std::vector<v8::Local<v8::ArrayBuffer>>());
+
+/// Deserialize a value in the isolate, transferred ArrayBuffer backing stores
+/// are moved into the isolate, so a value with transfers may be deserialized once.
+/// Throws std::runtime_error on failure.
+/// Must be invoked in a v8::HandleScope
+v8::Handle<v8::Value> deserialize(v8::Isolate* isolate, serialized_value& value);
+
+} // namespace v8pp
+
+#endif // V8PP_SERIALIZATION_HPP_INCLUDED
@@ -0,0 +1,162 @@
+#ifndef V8PP_SHARED_RING_HPP_INCLUDED
+#define V8PP_SHARED_RING_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+#include "v8pp/persistent.hpp"
+#include "v8pp/typed_array.hpp"
+
+namespace v8pp {
+
+/// Lock-free single producer, single consumer ring buffer of T records
+/// with storage shared between C++ threads and JavaScript in an ArrayBuffer.
+///
+/// JavaScript object returned by js_object() has properties:
+///   `header`   Int32Array with head index at `header[0]` and tail index at `header[16]`
+///   `records`  typed_array<element_type> with `record_length` elements per record
+///   `capacity` number of records, a power of 2
+///
+/// Head and tail are free-running 32-bit indices, the ring contains `(head - tail) | 0`
+/// records, a record index in `records` is `(index & (capacity - 1)) * record_length`.
+/// The producer writes a record and then increments head, the consumer reads
+/// a record and then increments tail. A JavaScript consumer:
+///
+///     var h = ring.header;
+///     while (h[0] !== h[16]) { var i = (h[16] & (ring.capacity - 1)) * ring.record_length; use(ring.records[i]); h[16] = (h[16] + 1) | 0; }
+///
+/// JavaScript accesses the header with plain loads and stores, there are no
+/// atomics for ArrayBuffers in this V8 version. Visibility of C++ updates is not
+/// guaranteed: an optimized JavaScript loop may keep a header value in a register,
+/// and record writes are ordered against index updates only by the hardware memory
+/// model. A JavaScript side should call into C++ between polls of an empty or
+/// full ring, and a record should be complete before the index update is seen.
+///
+/// The ring memory is owned by the C++ object, the ArrayBuffer is neutered
+/// on the ring destruction. Constructor, destructor and js_object() should be
+/// called in the isolate thread, try_push() and try_pop() in any thread.
+template<typename T>
+class shared_ring
+{
+public:
+	using layout = record_layout<T>;
+	using element_type = typename layout::element_type;
+	using array_type = typename typed_array<element_type>::array_type;
+
+	// std::is_trivially_copyable is not available in GCC 4.8
+	static_assert(std::is_trivial<T>::value, "record must be a trivial type");
+	static_assert(sizeof(T) == sizeof(element_type) * layout::count, "record must be an array of elements");
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(int32_t), "atomic index must be a plain 32-bit value");
+
+	/// Int32Array indices of head and tail in header, on different cache lines
+	enum { head_index = 0, tail_index = 16, header_size = 128 };
+
+	/// Create a ring with capacity rounded up to a power of 2
+	shared_ring(v8::Isolate* isolate, uint32_t capacity)
+		: isolate_(isolate)
+		, capacity_(1)
+	{
+		while (capacity_ < capacity)
+		{
+			capacity_ *= 2;
+			if (capacity_ == 0)
+			{
+				throw std::length_error("shared_ring capacity is too large");
+			}
+		}
+
+		size_t const size = header_size + size_t(capacity_) * sizeof(T);
+		storage_.reset(new uint64_t[(size + sizeof(uint64_t) - 1) / sizeof(uint64_t)]());
+		head_ = new(header() + head_index) std::atomic<uint32_t>(0);
+		tail_ = new(header() + tail_index) std::atomic<uint32_t>(0);
+
+		v8::HandleScope scope(isolate_);
+
+		v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate_, storage_.get(), size);
+		v8::Local<v8::Object> obj = v8::Object::New(isolate_);
+		obj->Set(to_v8(isolate_, "buffer"), buffer);
+		obj->Set(to_v8(isolate_, "header"), v8::Int32Array::New(buffer, 0, header_size / sizeof(int32_t)));
+		obj->Set(to_v8(isolate_, "records"),
+			typed_array<element_type>::create(buffer, header_size, size_t(capacity_) * layout::count));
+		obj->Set(to_v8(isolate_, "capacity"), to_v8(isolate_, capacity_));
+		obj->Set(to_v8(isolate_, "record_length"), to_v8(isolate_, static_cast<uint32_t>(layout::count)));
+		buffer_.Reset(isolate_, buffer);
+		object_.Reset(isolate_, obj);
+	}
+
+	~shared_ring()
+	{
+		v8::HandleScope scope(isolate_);
+		v8::Local<v8::ArrayBuffer>::New(isolate_, buffer_)->Neuter();
+	}
+
+	shared_ring(shared_ring const&) = delete;
+	shared_ring& operator=(shared_ring const&) = delete;
+
+	/// V8 isolate of the ring JavaScript object
+	v8::Isolate* isolate() { return isolate_; }
+
+	/// JavaScript object for the ring
+	v8::Local<v8::Object> js_object() { return v8::Local<v8::Object>::New(isolate_, object_); }
+
+	/// Maximum number of records in the ring
+	uint32_t capacity() const { return capacity_; }
+
+	/// Current number of records in the ring
+	uint32_t size() const
+	{
+		return head_->load(std::memory_order_acquire) - tail_->load(std::memory_order_acquire);
+	}
+
+	/// Append a record to the ring, return false if the ring is full.
+	/// Should be called in the producer thread only.
+	bool try_push(T const& record)
+	{
+		uint32_t const head = head_->load(std::memory_order_relaxed);
+		if (head - tail_->load(std::memory_order_acquire) == capacity_)
+		{
+			return false;
+		}
+		std::memcpy(records() + (head & (capacity_ - 1)), &record, sizeof(T));
+		head_->store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Remove a record from the ring, return false if the ring is empty.
+	/// Should be called in the consumer thread only.
+	bool try_pop(T& record)
+	{
+		uint32_t const tail = tail_->load(std::memory_order_relaxed);
+		if (head_->load(std::memory_order_acquire) == tail)
+		{
+			return false;
+		}
+		std::memcpy(&record, records() + (tail & (capacity_ - 1)), sizeof(T));
+		tail_->store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	int32_t* header() { return reinterpret_cast<int32_t*>(storage_.get()); }
+	T* records() { return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(storage_.get()) + header_size); }
+
+	v8::Isolate* isolate_;
+	uint32_t capacity_;
+	std::unique_ptr<uint64_t[]> storage_;
+	std::atomic<uint32_t>* head_;
+	std::atomic<uint32_t>* tail_;
+	persistent<v8::ArrayBuffer> buffer_;
+	persistent<v8::Object> object_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_SHARED_RING_HPP_INCLUDED
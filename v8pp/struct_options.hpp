@@ -0,0 +1,220 @@
+#ifndef V8PP_STRUCT_OPTIONS_HPP_INCLUDED
+#define V8PP_STRUCT_OPTIONS_HPP_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+#include "v8pp/persistent.hpp"
+
+namespace v8pp {
+
+/// Description of C++ options struct S fields to fill from V8 object
+/// in a single pass over its own properties:
+///
+///     struct db_options { std::string host; int port; };
+///
+///     v8pp::struct_options<db_options> db_fields(isolate);
+///     db_fields
+///         .field("host", &db_options::host, "localhost")
+///         .field("port", &db_options::port, 5432);
+///
+///     db_options opts = db_fields.get(obj);
+///
+/// Property names are dispatched to fields with a perfect hash table,
+/// built when the fields are added. Field names are limited to 64 characters.
+template<typename S>
+class struct_options
+{
+public:
+	explicit struct_options(v8::Isolate* isolate)
+		: isolate_(isolate)
+	{
+	}
+
+	struct_options(struct_options const&) = delete;
+	struct_options& operator=(struct_options const&) = delete;
+
+	/// V8 isolate of the field names
+	v8::Isolate* isolate() { return isolate_; }
+
+	/// Number of fields
+	size_t size() const { return fields_.size(); }
+
+	/// Add a field with default value, assigned when the property doesn't exist
+	template<typename T, typename U>
+	struct_options& field(char const* name, T S::*member, U const& default_value)
+	{
+		T const value(default_value);
+		add_field(name, member,
+			[member, value](S& s) { s.*member = value; });
+		return *this;
+	}
+
+	/// Add a field with its value in value-initialized S() as default
+	template<typename T>
+	struct_options& field(char const* name, T S::*member)
+	{
+		T const value = S().*member;
+		add_field(name, member,
+			[member, value](S& s) { s.*member = value; });
+		return *this;
+	}
+
+	/// Fill fields of struct from own properties of V8 object, or set their defaults.
+	/// Unknown property names are ignored or appended to `unknown` if it's not null.
+	/// Throws std::invalid_argument on property conversion failure
+	/// or on an exception in a property getter, which remains pending
+	void get(v8::Handle<v8::Object> obj, S& s, std::vector<std::string>* unknown = nullptr) const
+	{
+		v8::HandleScope scope(isolate_);
+
+		for (field_info const& f : fields_)
+		{
+			f.set_default(s);
+		}
+
+		v8::Local<v8::Array> names = obj->GetOwnPropertyNames();
+		for (uint32_t i = 0, count = names->Length(); i < count; ++i)
+		{
+			v8::Local<v8::Value> name = names->Get(i);
+			field_info const* f = name->IsString()? find(name.As<v8::String>()) : nullptr;
+			if (f)
+			{
+				v8::Local<v8::Value> value = obj->Get(name);
+				if (value.IsEmpty())
+				{
+					// the property getter has thrown, leave its exception pending
+					throw std::invalid_argument("failed to get property "
+						+ from_v8<std::string>(isolate_, name));
+				}
+				if (!value->IsUndefined())
+				{
+					f->set(isolate_, s, value);
+				}
+			}
+			else if (unknown)
+			{
+				unknown->push_back(from_v8<std::string>(isolate_, name->ToString()));
+			}
+		}
+	}
+
+	/// Create a struct from V8 object, see get(obj, s, unknown)
+	S get(v8::Handle<v8::Object> obj, std::vector<std::string>* unknown = nullptr) const
+	{
+		S s = S();
+		get(obj, s, unknown);
+		return s;
+	}
+
+private:
+	static int const max_name_length = 64;
+
+	struct field_info
+	{
+		persistent<v8::String> name;
+		uint32_t hash;
+		std::function<void(v8::Isolate*, S&, v8::Local<v8::Value>)> set;
+		std::function<void(S&)> set_default;
+	};
+
+	template<typename T>
+	void add_field(char const* name, T S::*member, std::function<void(S&)> set_default)
+	{
+		v8::HandleScope scope(isolate_);
+
+		v8::Local<v8::String> key = v8::String::NewFromUtf8(isolate_, name, v8::String::kInternalizedString);
+		if (key->Length() > max_name_length)
+		{
+			throw std::invalid_argument(std::string("too long field name ") + name);
+		}
+		if (find(key))
+		{
+			throw std::invalid_argument(std::string("duplicate field ") + name);
+		}
+
+		field_info f;
+		f.name.Reset(isolate_, key);
+		f.hash = hash(key);
+		f.set = [member](v8::Isolate* isolate, S& s, v8::Local<v8::Value> value)
+			{
+				s.*member = from_v8<T>(isolate, value);
+			};
+		f.set_default = std::move(set_default);
+		fields_.emplace_back(std::move(f));
+		try
+		{
+			build_table();
+		}
+		catch (std::exception const&)
+		{
+			fields_.pop_back();
+			throw;
+		}
+	}
+
+	// FNV-1a hash of UTF-16 string, copied on stack
+	static uint32_t hash(v8::Local<v8::String> str)
+	{
+		uint16_t buf[max_name_length];
+		int const length = str->Write(buf, 0, max_name_length, v8::String::NO_NULL_TERMINATION);
+		uint32_t result = 2166136261u;
+		for (int i = 0; i < length; ++i)
+		{
+			result = (result ^ buf[i]) * 16777619u;
+		}
+		return result;
+	}
+
+	// Find the smallest table size without hash collisions
+	void build_table()
+	{
+		size_t const max_size = fields_.size() * 64;
+		for (size_t size = fields_.size(); size <= max_size; ++size)
+		{
+			std::vector<int> table(size, -1);
+			bool collision = false;
+			for (size_t i = 0; i < fields_.size() && !collision; ++i)
+			{
+				int& slot = table[fields_[i].hash % size];
+				collision = (slot >= 0);
+				slot = static_cast<int>(i);
+			}
+			if (!collision)
+			{
+				table_.swap(table);
+				return;
+			}
+		}
+		throw std::runtime_error("no perfect hash table for fields");
+	}
+
+	field_info const* find(v8::Local<v8::String> name) const
+	{
+		if (table_.empty() || name->Length() > max_name_length)
+		{
+			return nullptr;
+		}
+		int const index = table_[hash(name) % table_.size()];
+		if (index < 0)
+		{
+			return nullptr;
+		}
+		field_info const& f = fields_[index];
+		return v8::Local<v8::String>::New(isolate_, f.name)->StrictEquals(name)? &f : nullptr;
+	}
+
+	v8::Isolate* isolate_;
+	std::vector<field_info> fields_;
+	std::vector<int> table_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_STRUCT_OPTIONS_HPP_INCLUDED
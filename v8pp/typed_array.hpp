@@ -0,0 +1,127 @@
+#ifndef V8PP_TYPED_ARRAY_HPP_INCLUDED
+#define V8PP_TYPED_ARRAY_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include <v8.h>
+
+namespace v8pp {
+
+namespace detail {
+
+template<size_t Size, bool Signed>
+struct integral_typed_array;
+
+#define V8PP_INTEGRAL_TYPED_ARRAY(size, is_signed, name) \
+	template<> struct integral_typed_array<size, is_signed> \
+	{ \
+		using type = v8::name; \
+		static bool is_valid(v8::Handle<v8::Value> value) { return value->Is##name(); } \
+	}
+
+V8PP_INTEGRAL_TYPED_ARRAY(1, true, Int8Array);
+V8PP_INTEGRAL_TYPED_ARRAY(1, false, Uint8Array);
+V8PP_INTEGRAL_TYPED_ARRAY(2, true, Int16Array);
+V8PP_INTEGRAL_TYPED_ARRAY(2, false, Uint16Array);
+V8PP_INTEGRAL_TYPED_ARRAY(4, true, Int32Array);
+V8PP_INTEGRAL_TYPED_ARRAY(4, false, Uint32Array);
+
+#undef V8PP_INTEGRAL_TYPED_ARRAY
+
+} // namespace detail
+
+/// JavaScript typed array for C++ arithmetic type T, like convert<T>
+/// Not defined for types without a typed array, such as 64-bit integers
+template<typename T, typename Enable = void>
+struct typed_array;
+
+template<typename T>
+struct typed_array<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) <= 4>::type>
+{
+	using element_type = T;
+	using traits = detail::integral_typed_array<sizeof(T), std::is_signed<T>::value>;
+	using array_type = typename traits::type;
+
+	static bool is_valid(v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && traits::is_valid(value);
+	}
+
+	static v8::Local<array_type> create(v8::Local<v8::ArrayBuffer> buffer, size_t offset, size_t length)
+	{
+		return array_type::New(buffer, offset, length);
+	}
+};
+
+template<typename T>
+struct typed_array<T, typename std::enable_if<std::is_enum<T>::value>::type>
+	: typed_array<typename std::underlying_type<T>::type>
+{
+};
+
+template<>
+struct typed_array<float>
+{
+	using element_type = float;
+	using array_type = v8::Float32Array;
+
+	static bool is_valid(v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && value->IsFloat32Array();
+	}
+
+	static v8::Local<array_type> create(v8::Local<v8::ArrayBuffer> buffer, size_t offset, size_t length)
+	{
+		return array_type::New(buffer, offset, length);
+	}
+};
+
+template<>
+struct typed_array<double>
+{
+	using element_type = double;
+	using array_type = v8::Float64Array;
+
+	static bool is_valid(v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty() && value->IsFloat64Array();
+	}
+
+	static v8::Local<array_type> create(v8::Local<v8::ArrayBuffer> buffer, size_t offset, size_t length)
+	{
+		return array_type::New(buffer, offset, length);
+	}
+};
+
+/// Layout of a fixed-size record T as `count` elements of `element_type`,
+/// viewed in JavaScript as a typed_array<element_type>.
+/// Specialize it for user-defined structs with fields of the same type:
+///
+///     template<>
+///     struct v8pp::record_layout<vec3>
+///     {
+///         using element_type = float;
+///         enum { count = 3 };
+///     };
+template<typename T, typename Enable = void>
+struct record_layout;
+
+template<typename T>
+struct record_layout<T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type>
+{
+	using element_type = T;
+	enum { count = 1 };
+};
+
+template<typename T, size_t N>
+struct record_layout<std::array<T, N>>
+{
+	using element_type = typename record_layout<T>::element_type;
+	enum { count = N * record_layout<T>::count };
+};
+
+} // namespace v8pp
+
+#endif // V8PP_TYPED_ARRAY_HPP_INCLUDED
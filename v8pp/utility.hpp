@@ -1,6 +1,8 @@
 #ifndef V8PP_UTILITY_HPP_INCLUDED
 #define V8PP_UTILITY_HPP_INCLUDED
 
+#include <cstring>
+#include <functional>
 #include <tuple>
 
 namespace v8pp { namespace detail {
@@ -140,6 +142,50 @@ typename function_traits<F>::return_type apply(F&& f, Args&&... args)
 	return std::forward<F>(f)(std::forward<Args>(args)...);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+//
+// Type information, stable across shared libraries without RTTI
+//
+class type_info
+{
+public:
+	constexpr type_info(char const* name, size_t size)
+		: name_(name)
+		, size_(size)
+	{
+	}
+
+	char const* name() const { return name_; }
+	size_t size() const { return size_; }
+
+	bool operator==(type_info const& other) const
+	{
+		return size_ == other.size_ && std::memcmp(name_, other.name_, size_) == 0;
+	}
+
+	bool operator!=(type_info const& other) const
+	{
+		return !(*this == other);
+	}
+
+private:
+	char const* name_;
+	size_t size_;
+};
+
+/// Type information for T, the signature contains the T type name
+template<typename T>
+type_info type_id()
+{
+#if defined(_MSC_VER)
+	char const* const signature = __FUNCSIG__;
+#else
+	char const* const signature = __PRETTY_FUNCTION__;
+#endif
+	static type_info const info(signature, std::strlen(signature));
+	return info;
+}
+
 }} // namespace v8pp::detail
 
 #endif // V8PP_UTILITY_HPP_INCLUDED
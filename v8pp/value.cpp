@@ -0,0 +1,513 @@
+#include "v8pp/value.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace v8pp {
+
+namespace {
+
+size_t const max_block_size = 16 * 1024 * 1024;
+
+} // unnamed namespace
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// value_arena
+//
+value_arena::value_arena(size_t initial_block_size)
+	: pos_(nullptr)
+	, end_(nullptr)
+	, next_block_size_(initial_block_size? initial_block_size : 1024)
+	, allocated_size_(0)
+{
+}
+
+void* value_arena::allocate(size_t size, size_t align)
+{
+	if (size == 0)
+	{
+		return nullptr;
+	}
+
+	uintptr_t const aligned = (reinterpret_cast<uintptr_t>(pos_) + align - 1) & ~(align - 1);
+	if (pos_ && aligned + size <= reinterpret_cast<uintptr_t>(end_))
+	{
+		pos_ = reinterpret_cast<char*>(aligned + size);
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	// large allocations get a dedicated block, leaving the current one in use
+	while (size + align > next_block_size_ / 2 && next_block_size_ < max_block_size)
+	{
+		next_block_size_ *= 2;
+	}
+	bool const dedicated = (size + align > next_block_size_ / 2);
+	size_t const block_size = dedicated? size + align : next_block_size_;
+	blocks_.emplace_back(new char[block_size]);
+	allocated_size_ += block_size;
+
+	char* const block = blocks_.back().get();
+	uintptr_t const result = (reinterpret_cast<uintptr_t>(block) + align - 1) & ~(align - 1);
+	if (!dedicated)
+	{
+		pos_ = reinterpret_cast<char*>(result + size);
+		end_ = block + block_size;
+		next_block_size_ = std::min(next_block_size_ * 2, max_block_size);
+	}
+	return reinterpret_cast<void*>(result);
+}
+
+char const* value_arena::copy_string(char const* str, size_t size)
+{
+	char* result = static_cast<char*>(allocate(size, 1));
+	if (size)
+	{
+		std::memcpy(result, str, size);
+	}
+	return result;
+}
+
+void value_arena::retain(std::shared_ptr<value_arena> const& other)
+{
+	if (other && other.get() != this
+		&& std::find(retained_.begin(), retained_.end(), other) == retained_.end())
+	{
+		retained_.push_back(other);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// value
+//
+bool value::as_bool() const
+{
+	if (!is_bool())
+	{
+		throw std::invalid_argument("value is not a boolean");
+	}
+	return node_.boolean;
+}
+
+double value::as_number() const
+{
+	if (!is_number())
+	{
+		throw std::invalid_argument("value is not a number");
+	}
+	return node_.number;
+}
+
+std::string value::as_string() const
+{
+	if (!is_string())
+	{
+		throw std::invalid_argument("value is not a string");
+	}
+	return std::string(node_.string, node_.size);
+}
+
+value value::operator[](size_t index) const
+{
+	if (index >= node_.size || (!is_array() && !is_object()))
+	{
+		throw std::out_of_range("value index out of range");
+	}
+	return value(arena_, is_array()? node_.items[index] : node_.members[index].value);
+}
+
+std::string value::key(size_t index) const
+{
+	if (index >= node_.size || !is_object())
+	{
+		throw std::out_of_range("value index out of range");
+	}
+	detail::value_member const& member = node_.members[index];
+	return std::string(member.key, member.key_size);
+}
+
+value value::operator[](char const* key) const
+{
+	return find(key, std::strlen(key));
+}
+
+bool value::contains(std::string const& key) const
+{
+	return find_member(key.data(), key.size()) != nullptr;
+}
+
+value value::find(char const* key, size_t key_size) const
+{
+	detail::value_member const* member = find_member(key, key_size);
+	return member? value(arena_, member->value) : value();
+}
+
+detail::value_member const* value::find_member(char const* key, size_t key_size) const
+{
+	if (is_object())
+	{
+		for (uint32_t i = 0; i < node_.size; ++i)
+		{
+			detail::value_member const& member = node_.members[i];
+			if (member.key_size == key_size && std::memcmp(member.key, key, key_size) == 0)
+			{
+				return &member;
+			}
+		}
+	}
+	return nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// value_builder
+//
+value_builder::value_builder()
+	: arena_(std::make_shared<value_arena>())
+{
+}
+
+value_builder::value_builder(std::shared_ptr<value_arena> arena)
+	: arena_(std::move(arena))
+{
+	if (!arena_)
+	{
+		throw std::invalid_argument("null value_arena");
+	}
+}
+
+value value_builder::boolean(bool b) const
+{
+	detail::value_node node;
+	node.type = value_type::boolean;
+	node.boolean = b;
+	return value(arena_, node);
+}
+
+value value_builder::number(double n) const
+{
+	detail::value_node node;
+	node.type = value_type::number;
+	node.number = n;
+	return value(arena_, node);
+}
+
+value value_builder::string(char const* str, size_t size) const
+{
+	detail::value_node node;
+	node.type = value_type::string;
+	node.size = static_cast<uint32_t>(size);
+	node.string = arena_->copy_string(str, size);
+	return value(arena_, node);
+}
+
+value value_builder::array(std::vector<value> const& items) const
+{
+	detail::value_node* nodes = arena_->allocate_array<detail::value_node>(items.size());
+	for (size_t i = 0; i < items.size(); ++i)
+	{
+		retain(items[i]);
+		new (nodes + i) detail::value_node(items[i].node_);
+	}
+
+	detail::value_node node;
+	node.type = value_type::array;
+	node.size = static_cast<uint32_t>(items.size());
+	node.items = nodes;
+	return value(arena_, node);
+}
+
+value value_builder::object(std::vector<std::pair<std::string, value>> const& members) const
+{
+	detail::value_member* nodes = arena_->allocate_array<detail::value_member>(members.size());
+	for (size_t i = 0; i < members.size(); ++i)
+	{
+		retain(members[i].second);
+		detail::value_member* member = new (nodes + i) detail::value_member;
+		member->key = arena_->copy_string(members[i].first.data(), members[i].first.size());
+		member->key_size = static_cast<uint32_t>(members[i].first.size());
+		member->value = members[i].second.node_;
+	}
+
+	detail::value_node node;
+	node.type = value_type::object;
+	node.size = static_cast<uint32_t>(members.size());
+	node.members = nodes;
+	return value(arena_, node);
+}
+
+void value_builder::retain(value const& item) const
+{
+	if (item.arena_ != arena_)
+	{
+		arena_->retain(item.arena_);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// convert<value>
+//
+namespace {
+
+// Containers being converted are kept in a V8 array, indexed by depth,
+// so each step of the iterative traversal needs only a local handle scope
+struct traversal_frame
+{
+	detail::value_node* items;
+	detail::value_member* members;
+	uint32_t index;
+	uint32_t size;
+};
+
+class value_reader
+{
+public:
+	value_reader(v8::Isolate* isolate, value_arena& arena)
+		: isolate_(isolate)
+		, arena_(arena)
+		, stack_(v8::Array::New(isolate))
+	{
+	}
+
+	void read(v8::Handle<v8::Value> root, detail::value_node& root_node)
+	{
+		read_node(root, root_node);
+		while (!frames_.empty())
+		{
+			size_t const depth = frames_.size() - 1;
+			traversal_frame& frame = frames_.back();
+			if (frame.index == frame.size)
+			{
+				frames_.pop_back();
+				continue;
+			}
+
+			v8::HandleScope scope(isolate_);
+
+			uint32_t const index = frame.index++;
+			uint32_t const slot = static_cast<uint32_t>(depth * 2);
+			v8::Local<v8::Object> obj = stack_->Get(slot).As<v8::Object>();
+			if (frame.items)
+			{
+				read_node(obj->Get(index), frame.items[index]);
+			}
+			else
+			{
+				v8::Local<v8::Value> name = stack_->Get(slot + 1).As<v8::Array>()->Get(index);
+				detail::value_member& member = frame.members[index];
+				v8::Local<v8::String> key = name->ToString();
+				member.key = copy_string(key, member.key_size);
+				read_node(obj->Get(name), member.value);
+			}
+		}
+	}
+
+private:
+	// frames_ may be reallocated in read_node, node points into the arena
+	void read_node(v8::Handle<v8::Value> value, detail::value_node& node)
+	{
+		node = detail::value_node();
+		if (value.IsEmpty())
+		{
+			// a throwing getter, the exception is pending in the isolate
+			throw std::invalid_argument("value property getter failed");
+		}
+		if (value->IsString())
+		{
+			node.type = value_type::string;
+			node.string = copy_string(value.As<v8::String>(), node.size);
+		}
+		else if (value->IsNumber())
+		{
+			node.type = value_type::number;
+			node.number = value->NumberValue();
+		}
+		else if (value->IsBoolean())
+		{
+			node.type = value_type::boolean;
+			node.boolean = value->BooleanValue();
+		}
+		else if (value->IsArray())
+		{
+			v8::Local<v8::Array> array = value.As<v8::Array>();
+			node.type = value_type::array;
+			node.size = array->Length();
+			detail::value_node* items = arena_.allocate_array<detail::value_node>(node.size);
+			node.items = items;
+			push(array, v8::Local<v8::Array>(), items, nullptr, node.size);
+		}
+		else if (value->IsObject() && !value->IsFunction())
+		{
+			v8::Local<v8::Object> obj = value.As<v8::Object>();
+			v8::Local<v8::Array> names = obj->GetOwnPropertyNames();
+			node.type = value_type::object;
+			node.size = names->Length();
+			detail::value_member* members = arena_.allocate_array<detail::value_member>(node.size);
+			node.members = members;
+			push(obj, names, nullptr, members, node.size);
+		}
+	}
+
+	void push(v8::Local<v8::Object> obj, v8::Local<v8::Array> names,
+		detail::value_node* items, detail::value_member* members, uint32_t size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+		if (frames_.size() >= convert<value>::max_depth)
+		{
+			throw std::invalid_argument("value nesting is too deep");
+		}
+		uint32_t const slot = static_cast<uint32_t>(frames_.size() * 2);
+		stack_->Set(slot, obj);
+		if (!names.IsEmpty())
+		{
+			stack_->Set(slot + 1, names);
+		}
+		traversal_frame const frame = { items, members, 0, size };
+		frames_.push_back(frame);
+	}
+
+	char const* copy_string(v8::Local<v8::String> str, uint32_t& size)
+	{
+		int const length = str->Utf8Length();
+		char* data = static_cast<char*>(arena_.allocate(length, 1));
+		if (length)
+		{
+			str->WriteUtf8(data, length, nullptr, v8::String::NO_NULL_TERMINATION);
+		}
+		size = static_cast<uint32_t>(length);
+		return data;
+	}
+
+	v8::Isolate* isolate_;
+	value_arena& arena_;
+	v8::Local<v8::Array> stack_;
+	std::vector<traversal_frame> frames_;
+};
+
+class value_writer
+{
+public:
+	explicit value_writer(v8::Isolate* isolate)
+		: isolate_(isolate)
+		, stack_(v8::Array::New(isolate))
+	{
+	}
+
+	v8::Local<v8::Value> write(detail::value_node const& root_node)
+	{
+		v8::Local<v8::Value> root = write_node(root_node);
+		while (!frames_.empty())
+		{
+			size_t const depth = frames_.size() - 1;
+			traversal_frame& frame = frames_.back();
+			if (frame.index == frame.size)
+			{
+				frames_.pop_back();
+				continue;
+			}
+
+			v8::HandleScope scope(isolate_);
+
+			uint32_t const index = frame.index++;
+			v8::Local<v8::Object> obj = stack_->Get(static_cast<uint32_t>(depth)).As<v8::Object>();
+			if (frame.items)
+			{
+				detail::value_node const& item = frame.items[index];
+				obj->Set(index, write_node(item));
+			}
+			else
+			{
+				detail::value_member const& member = frame.members[index];
+				v8::Local<v8::String> key = v8::String::NewFromUtf8(isolate_, member.key,
+					v8::String::kInternalizedString, static_cast<int>(member.key_size));
+				obj->Set(key, write_node(member.value));
+			}
+		}
+		return root;
+	}
+
+private:
+	v8::Local<v8::Value> write_node(detail::value_node const& node)
+	{
+		switch (node.type)
+		{
+		case value_type::boolean:
+			return v8::Boolean::New(isolate_, node.boolean);
+		case value_type::number:
+			return v8::Number::New(isolate_, node.number);
+		case value_type::string:
+			return v8::String::NewFromUtf8(isolate_, node.string,
+				v8::String::kNormalString, static_cast<int>(node.size));
+		case value_type::array:
+			{
+				v8::Local<v8::Array> array = v8::Array::New(isolate_, static_cast<int>(node.size));
+				push(array, const_cast<detail::value_node*>(node.items), nullptr, node.size);
+				return array;
+			}
+		case value_type::object:
+			{
+				v8::Local<v8::Object> obj = v8::Object::New(isolate_);
+				push(obj, nullptr, const_cast<detail::value_member*>(node.members), node.size);
+				return obj;
+			}
+		default:
+			return v8::Null(isolate_);
+		}
+	}
+
+	void push(v8::Local<v8::Object> obj, detail::value_node* items, detail::value_member* members, uint32_t size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+		if (frames_.size() >= convert<value>::max_depth)
+		{
+			throw std::invalid_argument("value nesting is too deep");
+		}
+		stack_->Set(static_cast<uint32_t>(frames_.size()), obj);
+		traversal_frame const frame = { items, members, 0, size };
+		frames_.push_back(frame);
+	}
+
+	v8::Isolate* isolate_;
+	v8::Local<v8::Array> stack_;
+	std::vector<traversal_frame> frames_;
+};
+
+} // unnamed namespace
+
+size_t const convert<value>::max_depth;
+
+value convert<value>::from_v8(v8::Isolate* isolate, v8::Handle<v8::Value> value)
+{
+	if (value.IsEmpty())
+	{
+		throw std::invalid_argument("expected value");
+	}
+
+	v8::HandleScope scope(isolate);
+
+	from_type result;
+	result.arena_ = std::make_shared<value_arena>();
+	value_reader reader(isolate, *result.arena_);
+	reader.read(value, result.node_);
+	return result;
+}
+
+v8::Handle<v8::Value> convert<value>::to_v8(v8::Isolate* isolate, from_type const& value)
+{
+	v8::EscapableHandleScope scope(isolate);
+
+	value_writer writer(isolate);
+	return scope.Escape(writer.write(value.node_));
+}
+
+} // namespace v8pp
@@ -0,0 +1,231 @@
+#ifndef V8PP_VALUE_HPP_INCLUDED
+#define V8PP_VALUE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <v8.h>
+
+#include "v8pp/convert.hpp"
+
+namespace v8pp {
+
+/// Memory arena for value nodes and strings. Allocates blocks of growing size,
+/// all memory is freed at once when the arena is destroyed.
+class value_arena
+{
+public:
+	explicit value_arena(size_t initial_block_size = 64 * 1024);
+
+	value_arena(value_arena const&) = delete;
+	value_arena& operator=(value_arena const&) = delete;
+
+	/// Allocate uninitialized memory
+	void* allocate(size_t size, size_t align = alignof(double));
+
+	/// Allocate array of count T elements
+	template<typename T>
+	T* allocate_array(size_t count)
+	{
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+	/// Copy string into the arena
+	char const* copy_string(char const* str, size_t size);
+
+	/// Keep another arena alive while this one exists
+	void retain(std::shared_ptr<value_arena> const& other);
+
+	/// Number of allocated blocks
+	size_t block_count() const { return blocks_.size(); }
+
+	/// Total size of allocated blocks, in bytes
+	size_t allocated_size() const { return allocated_size_; }
+
+private:
+	std::vector<std::unique_ptr<char[]>> blocks_;
+	std::vector<std::shared_ptr<value_arena>> retained_;
+	char* pos_;
+	char* end_;
+	size_t next_block_size_;
+	size_t allocated_size_;
+};
+
+/// Type of dynamic value
+enum class value_type : uint8_t
+{
+	null,
+	boolean,
+	number,
+	string,
+	array,
+	object,
+};
+
+namespace detail {
+
+struct value_member;
+
+// Immutable value node in an arena
+struct value_node
+{
+	value_type type;
+	uint32_t size; // bytes of string, items of array, members of object
+	union
+	{
+		bool boolean;
+		double number;
+		char const* string;
+		value_node const* items;
+		value_member const* members;
+	};
+
+	value_node() : type(value_type::null), size(0), number(0) {}
+};
+
+struct value_member
+{
+	char const* key;
+	uint32_t key_size;
+	value_node value;
+};
+
+} // namespace detail
+
+/// Dynamic value: null, boolean, number, string, array or object,
+/// like a JSON value. Nodes and strings live in a shared value_arena,
+/// so a value is a cheap copyable reference into an immutable tree.
+///
+/// convert<value> walks V8 values and value trees iteratively with
+/// a new arena for each from_v8() call. Undefined and functions are
+/// converted to null, objects other than arrays to objects with
+/// their own properties.
+class value
+{
+public:
+	/// Null value
+	value() {}
+
+	value_type type() const { return node_.type; }
+
+	bool is_null() const { return node_.type == value_type::null; }
+	bool is_bool() const { return node_.type == value_type::boolean; }
+	bool is_number() const { return node_.type == value_type::number; }
+	bool is_string() const { return node_.type == value_type::string; }
+	bool is_array() const { return node_.type == value_type::array; }
+	bool is_object() const { return node_.type == value_type::object; }
+
+	/// Value of a boolean, throws std::invalid_argument for other types
+	bool as_bool() const;
+
+	/// Value of a number, throws std::invalid_argument for other types
+	double as_number() const;
+
+	/// Copy of a string, throws std::invalid_argument for other types
+	std::string as_string() const;
+
+	/// UTF-8 string data in the arena, not null-terminated, with size() bytes
+	char const* string_data() const { return is_string()? node_.string : nullptr; }
+
+	/// Number of string bytes, array items or object members, 0 for other types
+	size_t size() const { return node_.size; }
+
+	/// Array item or object member value at index,
+	/// throws std::out_of_range for invalid index
+	value operator[](size_t index) const;
+	value operator[](int index) const { return operator[](static_cast<size_t>(index)); }
+
+	/// Object member key at index,
+	/// throws std::out_of_range for invalid index
+	std::string key(size_t index) const;
+
+	/// Object member value with key, null if there is no such member
+	value operator[](char const* key) const;
+	value operator[](std::string const& key) const { return find(key.data(), key.size()); }
+
+	/// Is there an object member with key
+	bool contains(std::string const& key) const;
+
+	/// Arena of the value, null for scalars created without it
+	std::shared_ptr<value_arena> const& arena() const { return arena_; }
+
+private:
+	friend class value_builder;
+	friend struct convert<value>;
+
+	value(std::shared_ptr<value_arena> const& arena, detail::value_node const& node)
+		: arena_(arena)
+		, node_(node)
+	{
+	}
+
+	value find(char const* key, size_t key_size) const;
+	detail::value_member const* find_member(char const* key, size_t key_size) const;
+
+	std::shared_ptr<value_arena> arena_;
+	detail::value_node node_;
+};
+
+/// Builder of values in an arena:
+///
+///     v8pp::value_builder b;
+///     v8pp::value v = b.object({ { "name", b.string("x") }, { "size", b.number(1) } });
+class value_builder
+{
+public:
+	value_builder();
+	explicit value_builder(std::shared_ptr<value_arena> arena);
+
+	std::shared_ptr<value_arena> const& arena() const { return arena_; }
+
+	value null() const { return value(); }
+	value boolean(bool b) const;
+	value number(double n) const;
+	value string(char const* str, size_t size) const;
+	value string(char const* str) const { return string(str, std::char_traits<char>::length(str)); }
+	value string(std::string const& str) const { return string(str.data(), str.size()); }
+
+	/// Array of items, from this or other arenas
+	value array(std::vector<value> const& items) const;
+
+	/// Object of members, from this or other arenas
+	value object(std::vector<std::pair<std::string, value>> const& members) const;
+
+private:
+	void retain(value const& item) const;
+
+	std::shared_ptr<value_arena> arena_;
+};
+
+template<>
+struct convert<value>
+{
+	using from_type = value;
+	using to_type = v8::Handle<v8::Value>;
+
+	static bool is_valid(v8::Isolate*, v8::Handle<v8::Value> value)
+	{
+		return !value.IsEmpty();
+	}
+
+	/// Convert V8 value into a new arena. Throws std::invalid_argument
+	/// on too deep nesting, such as a cyclic object, or on a throwing getter,
+	/// its JavaScript exception is left for a v8::TryCatch of the caller
+	static from_type from_v8(v8::Isolate* isolate, v8::Handle<v8::Value> value);
+
+	static to_type to_v8(v8::Isolate* isolate, from_type const& value);
+
+	/// Maximum nesting depth of arrays and objects
+	static size_t const max_depth = 4096;
+};
+
+template<>
+struct is_wrapped_class<value> : std::false_type {};
+
+} // namespace v8pp
+
+#endif // V8PP_VALUE_HPP_INCLUDED
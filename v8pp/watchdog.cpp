@@ -0,0 +1,197 @@
+#include "v8pp/watchdog.hpp"
+
+#include <algorithm>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace v8pp {
+
+// interval to check CPU time of watched runs
+static watchdog::duration const cpu_poll_interval(5);
+
+static std::intptr_t current_thread_cpu_clock()
+{
+#if defined(WIN32)
+	HANDLE thread = nullptr;
+	::DuplicateHandle(::GetCurrentProcess(), ::GetCurrentThread(), ::GetCurrentProcess(),
+		&thread, THREAD_QUERY_INFORMATION, FALSE, 0);
+	return reinterpret_cast<std::intptr_t>(thread);
+#else
+	clockid_t clock;
+	if (pthread_getcpuclockid(pthread_self(), &clock) != 0)
+	{
+		clock = CLOCK_THREAD_CPUTIME_ID;
+	}
+	return static_cast<std::intptr_t>(clock);
+#endif
+}
+
+static void close_cpu_clock(std::intptr_t clock)
+{
+#if defined(WIN32)
+	if (clock)
+	{
+		::CloseHandle(reinterpret_cast<HANDLE>(clock));
+	}
+#else
+	(void)clock;
+#endif
+}
+
+static watchdog::duration thread_cpu_time(std::intptr_t clock)
+{
+#if defined(WIN32)
+	FILETIME creation, exit, kernel, user;
+	if (!::GetThreadTimes(reinterpret_cast<HANDLE>(clock), &creation, &exit, &kernel, &user))
+	{
+		return watchdog::duration::zero();
+	}
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+	// 100 nanosecond intervals
+	return watchdog::duration((k.QuadPart + u.QuadPart) / 10000);
+#else
+	timespec ts;
+	if (clock_gettime(static_cast<clockid_t>(clock), &ts) != 0)
+	{
+		return watchdog::duration::zero();
+	}
+	return std::chrono::duration_cast<watchdog::duration>(
+		std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec));
+#endif
+}
+
+watchdog::watchdog()
+	: stop_(false)
+	, thread_(&watchdog::watch, this)
+{
+}
+
+watchdog::~watchdog()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+	thread_.join();
+}
+
+watchdog& watchdog::instance()
+{
+	static watchdog instance;
+	return instance;
+}
+
+void watchdog::add(run& r)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		runs_.push_back(&r);
+	}
+	cond_.notify_all();
+}
+
+void watchdog::remove(run& r)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	runs_.remove(&r);
+	if (r.reason)
+	{
+		// the run has finished, allow further script execution in the isolate
+		v8::V8::CancelTerminateExecution(r.isolate);
+	}
+}
+
+void watchdog::terminate(run& r, char const* reason)
+{
+	char const* expected = nullptr;
+	if (r.reason.compare_exchange_strong(expected, reason))
+	{
+		v8::V8::TerminateExecution(r.isolate);
+	}
+}
+
+void watchdog::watch()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!stop_)
+	{
+		auto const now = std::chrono::steady_clock::now();
+		auto wake_time = std::chrono::steady_clock::time_point::max();
+
+		for (run* r : runs_)
+		{
+			if (r->reason)
+			{
+				continue;
+			}
+			if (now >= r->wall_deadline)
+			{
+				terminate(*r, "wall time limit exceeded");
+				continue;
+			}
+			wake_time = std::min(wake_time, r->wall_deadline);
+
+			if (r->cpu_limit != duration::zero())
+			{
+				duration const used = thread_cpu_time(r->cpu_clock) - r->cpu_start;
+				if (used >= r->cpu_limit)
+				{
+					terminate(*r, "CPU time limit exceeded");
+					continue;
+				}
+				// CPU time advances not faster than wall time
+				wake_time = std::min(wake_time, now + std::max(cpu_poll_interval, r->cpu_limit - used));
+			}
+		}
+
+		if (wake_time == std::chrono::steady_clock::time_point::max())
+		{
+			cond_.wait(lock);
+		}
+		else
+		{
+			cond_.wait_until(lock, wake_time);
+		}
+	}
+}
+
+watchdog::scope::scope(watchdog& wd, v8::Isolate* isolate, duration wall_time, duration cpu_time)
+	: watchdog_(wd)
+{
+	run_.isolate = isolate;
+	run_.wall_deadline = (wall_time != duration::zero())?
+		std::chrono::steady_clock::now() + wall_time : std::chrono::steady_clock::time_point::max();
+	run_.cpu_limit = cpu_time;
+	run_.cpu_clock = 0;
+	run_.cpu_start = duration::zero();
+	if (cpu_time != duration::zero())
+	{
+		run_.cpu_clock = current_thread_cpu_clock();
+		run_.cpu_start = thread_cpu_time(run_.cpu_clock);
+	}
+	run_.reason = nullptr;
+
+	watchdog_.add(run_);
+}
+
+watchdog::scope::~scope()
+{
+	watchdog_.remove(run_);
+	close_cpu_clock(run_.cpu_clock);
+}
+
+void watchdog::scope::terminate(char const* reason)
+{
+	std::lock_guard<std::mutex> lock(watchdog_.mutex_);
+	watchdog_.terminate(run_, reason);
+}
+
+} // namespace v8pp
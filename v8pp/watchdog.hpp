@@ -0,0 +1,84 @@
+#ifndef V8PP_WATCHDOG_HPP_INCLUDED
+#define V8PP_WATCHDOG_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#include <v8.h>
+
+namespace v8pp {
+
+/// Watchdog thread that terminates script execution in V8 isolates
+/// exceeding wall time or CPU time limits
+class watchdog
+{
+public:
+	using duration = std::chrono::milliseconds;
+
+	watchdog();
+	~watchdog();
+
+	watchdog(watchdog const&) = delete;
+	watchdog& operator=(watchdog const&) = delete;
+
+	/// Process-wide watchdog instance
+	static watchdog& instance();
+
+	class scope;
+
+private:
+	struct run
+	{
+		v8::Isolate* isolate;
+		std::chrono::steady_clock::time_point wall_deadline;
+		duration cpu_limit;
+		duration cpu_start;
+		std::intptr_t cpu_clock;
+		std::atomic<char const*> reason;
+	};
+
+	void add(run& r);
+	void remove(run& r);
+	void terminate(run& r, char const* reason);
+	void watch();
+
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::list<run*> runs_;
+	bool stop_;
+	std::thread thread_;
+};
+
+/// Watched script run in the current thread, removed from the watchdog on destruction.
+/// Zero limit means no limit.
+class watchdog::scope
+{
+public:
+	scope(watchdog& wd, v8::Isolate* isolate, duration wall_time, duration cpu_time);
+	~scope();
+
+	scope(scope const&) = delete;
+	scope& operator=(scope const&) = delete;
+
+	/// Terminate the script execution with a reason, may be called from any thread
+	void terminate(char const* reason);
+
+	/// Is the run terminated or cancelled, cheap enough for native functions to poll
+	bool terminated() const { return run_.reason != nullptr; }
+
+	/// Termination reason, nullptr if the run was not terminated
+	char const* reason() const { return run_.reason; }
+
+private:
+	watchdog& watchdog_;
+	run run_;
+};
+
+} // namespace v8pp
+
+#endif // V8PP_WATCHDOG_HPP_INCLUDED